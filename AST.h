@@ -4,9 +4,20 @@
 
 #pragma once
 
+#include <algorithm>
+#include <functional>
 #include "Types.h"
+#include "Arena.h"
 #include "Value.h"
+#include "Operators.h"
+#include "SpecializingOperator.h"
 #include "Interpreter.h"
+#include "ScopeAnalysis.h"
+#include "Bytecode.h"
+#include "BytecodeVM.h"
+#include "Log.h"
+#include "CodeCache.h"
+#include "JIT.h"
 
 namespace LibJS {
 
@@ -16,37 +27,147 @@ namespace LibJS {
         }
     }
 
+    class Program;
+
+    class Statement;
+
+    class Literal;
+
+    // A node of the closure compiled tier: the node's evaluation with its operands, operator and resolved variable
+    // locations bound once, see ASTNode::compile.
+    using CompiledNode = std::function<Value(Interpreter &interpreter)>;
+
+    // Stores a value into a variable whose location was resolved at compile time.
+    using CompiledStore = std::function<void(Interpreter &interpreter, const Value &value)>;
+
+    // State of the constant folding pass, see Program::foldConstants.
+    class ConstantFolder final {
+    public:
+        explicit ConstantFolder(Program &program)
+                : m_program{program} {}
+
+        Literal *makeLiteral(const Value &value);
+
+        Statement *makeEmptyStatement();
+
+        // Branches that declare names can't be dropped, the names are hoisted into the enclosing scope.
+        bool declaresNames(Statement *statement);
+
+    private:
+        Program &m_program;
+        // Folding runs the same operators as the interpreter. Strings they create land here and are then copied into
+        // the program's arena.
+        Heap m_heap;
+    };
+
+    // Nodes are allocated in their Program's arena and never deleted one by one, see Program::make.
     class ASTNode {
     public:
         ASTNode() = default;
 
-        virtual ~ASTNode() {
-            std::cout << "~ASTNode" << std::endl;
-        };
-
         virtual Value execute(Interpreter &interpreter) {
             return {};
         }
 
         virtual void print(int32_t indent) const {}
+
+        // Writes the node for the code cache, see ASTWriter.
+        virtual void serialize(ASTWriter &writer) const {
+            writer.unsupported();
+        }
+
+        // Declares the names this node introduces into the enclosing function scope, before anything is resolved.
+        virtual void hoistDeclarations(ScopeAnalyzer &) {}
+
+        // Resolves the identifiers below this node to frame slots.
+        virtual void analyzeScope(ScopeAnalyzer &) {}
+
+        // Emits the bytecode for this node and returns the register holding its value.
+        virtual Bytecode::Register generateBytecode(Bytecode::Generator &generator) {
+            generator.unsupported();
+            return 0;
+        }
+
+        // Evaluating a pure node has no side effects, so operands evaluated before it can stay in their registers.
+        virtual bool isPure() const { return false; }
+
+        // Compiles the node for the closure compiled tier. Nodes without their own version run through execute(), so
+        // compiled and tree-walking nodes can be mixed freely.
+        virtual CompiledNode compile() {
+            return [this](Interpreter &interpreter) { return execute(interpreter); };
+        }
     };
 
 
     class Statement : public ASTNode {
     public:
-        virtual ~Statement() {
-            std::cout << "~Statement" << std::endl;
-        }
+        // Returns the statement that replaces this one, or nullptr if it can be dropped altogether.
+        virtual Statement *foldConstants(ConstantFolder &) { return this; }
+
+        virtual bool isFunctionDeclaration() const { return false; }
     };
 
-    class BlockStatement : public Statement {
-    public:
-        BlockStatement(Vector<SharedPtr<Statement>> body)
-                : m_body{std::move(body)} {}
+    // Function declarations move to the front of their statement list, so every tier binds them when the scope is
+    // entered and they can be called before the statement that declares them. Moving them again is a no-op, the
+    // statements are hoisted once per analysis pass.
+    static void hoistStatements(ScopeAnalyzer &analyzer, Span<Statement *> statements) {
+        std::stable_partition(statements.begin(), statements.end(), [](const Statement *statement) {
+            return statement->isFunctionDeclaration();
+        });
+        for (const auto &statement : statements) {
+            statement->hoistDeclarations(analyzer);
+        }
+    }
+
+    // Folds the statements in place and returns how many are left.
+    static size_t foldStatements(ConstantFolder &folder, Span<Statement *> statements) {
+        size_t count = 0;
+        for (auto *statement : statements) {
+            if (Statement *folded = statement->foldConstants(folder)) {
+                statements[count++] = folded;
+            }
+        }
+        return count;
+    }
+
+    // Branches and loop bodies can't disappear, a dropped statement is replaced by an empty one.
+    static Statement *foldBranch(ConstantFolder &folder, Statement *branch) {
+        Statement *folded = branch->foldConstants(folder);
+        return folded ? folded : folder.makeEmptyStatement();
+    }
 
-        virtual ~BlockStatement() {
-            std::cout << "~BlockStatement" << std::endl;
+    static Bytecode::Register generateStatements(Bytecode::Generator &generator, Span<Statement *const> statements) {
+        for (const auto &statement : statements) {
+            const auto mark = generator.registerMark();
+            statement->generateBytecode(generator);
+            generator.releaseRegisters(mark);
         }
+        return 0;
+    }
+
+    static CompiledNode compileStatements(Span<Statement *const> statements) {
+        Vector<std::pair<Statement *, CompiledNode>> compiled;
+        compiled.reserve(statements.size());
+        for (const auto &statement : statements) {
+            compiled.emplace_back(statement, statement->compile());
+        }
+        return [compiled = std::move(compiled)](Interpreter &interpreter) {
+            for (const auto &[node, statement] : compiled) {
+                interpreter.safepoint();
+                interpreter.enterStatement(node);
+                statement(interpreter);
+                if (interpreter.isUnwinding()) {
+                    break;
+                }
+            }
+            return Value();
+        };
+    }
+
+    class BlockStatement : public Statement {
+    public:
+        BlockStatement(Span<Statement *> body)
+                : m_body{body} {}
 
         virtual void print(int32_t indent) const override {
             if (!m_body.empty()) {
@@ -60,27 +181,64 @@ namespace LibJS {
             }
         }
 
+        virtual void serialize(ASTWriter &writer) const override {
+            writer.writeKind(NodeKind::BlockStatement);
+            writer.writeNodes(m_body);
+        }
+
         virtual Value execute(Interpreter &interpreter) override {
             for (const auto &statements : m_body) {
+                interpreter.safepoint();
+                interpreter.enterStatement(statements);
                 statements->execute(interpreter);
+                if (interpreter.isUnwinding()) {
+                    break;
+                }
             }
             return {};
         }
 
+        virtual void hoistDeclarations(ScopeAnalyzer &analyzer) override {
+            hoistStatements(analyzer, m_body);
+        }
+
+        virtual void analyzeScope(ScopeAnalyzer &analyzer) override {
+            for (const auto &statement : m_body) {
+                statement->analyzeScope(analyzer);
+            }
+        }
+
+        virtual Bytecode::Register generateBytecode(Bytecode::Generator &generator) override {
+            return generateStatements(generator, m_body);
+        }
+
+        virtual CompiledNode compile() override {
+            return compileStatements(m_body);
+        }
+
+        virtual Statement *foldConstants(ConstantFolder &folder) override {
+            m_body = m_body.first(foldStatements(folder, m_body));
+            return this;
+        }
+
     private:
-        Vector<SharedPtr<Statement>> m_body;
+        Span<Statement *> m_body;
     };
 
     class Expression : public ASTNode {
     public:
-        virtual ~Expression() override {}
+        // Returns the expression that replaces this one, usually a Literal if the value is known up front.
+        virtual Expression *foldConstants(ConstantFolder &) { return this; }
     };
 
     class Identifier : public Expression {
     public:
-        Identifier(const String &name)
+        Identifier(Atom name)
                 : m_name{name} {}
 
+        Identifier(std::string_view name)
+                : m_name{Atom::intern(name)} {}
+
         virtual void print(int32_t indent) const override {
             printIndent(indent);
             std::cout << "[Identifier]" << std::endl;
@@ -88,22 +246,119 @@ namespace LibJS {
             std::cout << "name: " << m_name << std::endl;
         }
 
+        virtual void serialize(ASTWriter &writer) const override {
+            writer.writeKind(NodeKind::Identifier);
+            writer.writeAtom(m_name);
+        }
+
         virtual Value execute(Interpreter &interpreter) override {
-            return interpreter.getVariable(m_name).value_or(JsUndefined());
+            return interpreter.getVariable(m_location);
+        }
+
+        virtual void analyzeScope(ScopeAnalyzer &analyzer) override {
+            m_location = analyzer.resolve(m_name);
+        }
+
+        virtual Bytecode::Register generateBytecode(Bytecode::Generator &generator) override {
+            if (!m_location.isResolved()) {
+                return generator.loadConstant(JsUndefined());
+            }
+            if (m_location.isLocal()) {
+                return static_cast<Bytecode::Register>(m_location.index);
+            }
+            if (m_location.hops > std::numeric_limits<uint8_t>::max()) {
+                generator.unsupported();
+                return 0;
+            }
+            const auto reg = generator.allocateRegister();
+            if (m_location.kind == VariableLocation::Kind::Global) {
+                generator.emit(Bytecode::OpCode::GetGlobal, reg, m_location.index);
+            } else {
+                generator.emit(Bytecode::OpCode::GetVariable, reg, m_location.index, 0, m_location.hops);
+            }
+            return reg;
+        }
+
+        virtual bool isPure() const override { return true; }
+
+        // Stores the value in `value` into the variable and returns the register now holding it.
+        Bytecode::Register generateStore(Bytecode::Generator &generator, Bytecode::Register value) const {
+            if (!m_location.isResolved() || m_location.hops > std::numeric_limits<uint8_t>::max()) {
+                generator.unsupported();
+                return value;
+            }
+            if (m_location.isLocal()) {
+                const auto slot = static_cast<Bytecode::Register>(m_location.index);
+                if (slot != value) {
+                    generator.emit(Bytecode::OpCode::Move, slot, value);
+                }
+                return slot;
+            }
+            if (m_location.kind == VariableLocation::Kind::Global) {
+                generator.emit(Bytecode::OpCode::SetGlobal, value, m_location.index);
+            } else {
+                generator.emit(Bytecode::OpCode::SetVariable, value, m_location.index, 0, m_location.hops);
+            }
+            return value;
+        }
+
+        // The location's kind is switched on here once instead of on every access.
+        virtual CompiledNode compile() override {
+            const int32_t index = m_location.index;
+            switch (m_location.kind) {
+                case VariableLocation::Kind::Local:
+                    return [index](Interpreter &interpreter) { return interpreter.currentStackFrame().slot(index); };
+                case VariableLocation::Kind::Global:
+                    return [index](Interpreter &interpreter) { return interpreter.globalStackFrame().slot(index); };
+                case VariableLocation::Kind::Environment:
+                    return [hops = m_location.hops, index](Interpreter &interpreter) {
+                        return interpreter.environmentAt(hops)->slot(index);
+                    };
+                default:
+                    return [](Interpreter &) { return Value(); };
+            }
+        }
+
+        CompiledStore compileStore() const {
+            const int32_t index = m_location.index;
+            switch (m_location.kind) {
+                case VariableLocation::Kind::Local:
+                    return [index](Interpreter &interpreter, const Value &value) {
+                        interpreter.currentStackFrame().slot(index) = value;
+                    };
+                case VariableLocation::Kind::Global:
+                    return [index](Interpreter &interpreter, const Value &value) {
+                        interpreter.globalStackFrame().slot(index) = value;
+                    };
+                default:
+                    return [location = m_location](Interpreter &interpreter, const Value &value) {
+                        interpreter.setVariable(location, value);
+                    };
+            }
+        }
+
+        void declare(ScopeAnalyzer &analyzer) {
+            m_location = analyzer.declare(m_name);
+        }
+
+        // Used for assignment targets, which declare a global if the name isn't declared anywhere.
+        void analyzeAssignmentTarget(ScopeAnalyzer &analyzer) {
+            m_location = analyzer.resolveAssignmentTarget(m_name);
         }
 
-        const String &name() const { return m_name; }
+        Atom name() const { return m_name; }
+
+        const VariableLocation &location() const { return m_location; }
 
     private:
-        String m_name;
+        Atom m_name;
+        VariableLocation m_location;
     };
 
     class ScopeNode : public Statement {
     public:
-        template<typename T, typename... Args>
-        void append(Args &&... args) {
-            auto node = std::make_shared<T>(std::forward<Args>(args)...);
-            m_body.push_back(std::move(node));
+        void append(Statement *statement) {
+            m_body.push_back(statement);
         }
 
         virtual void print(int32_t indent) const override {
@@ -114,39 +369,63 @@ namespace LibJS {
 
         virtual Value execute(Interpreter &interpreter) {
             for (const auto &child : m_body) {
+                interpreter.safepoint();
+                interpreter.enterStatement(child);
                 child->execute(interpreter);
+                if (interpreter.isUnwinding()) {
+                    break;
+                }
             }
             return {};
         }
 
+        virtual void hoistDeclarations(ScopeAnalyzer &analyzer) override {
+            hoistStatements(analyzer, m_body);
+        }
+
+        virtual void analyzeScope(ScopeAnalyzer &analyzer) override {
+            for (const auto &child : m_body) {
+                child->analyzeScope(analyzer);
+            }
+        }
+
+        virtual Bytecode::Register generateBytecode(Bytecode::Generator &generator) override {
+            return generateStatements(generator, m_body);
+        }
+
+        virtual CompiledNode compile() override {
+            return compileStatements(m_body);
+        }
+
+        virtual Statement *foldConstants(ConstantFolder &folder) override {
+            m_body.resize(foldStatements(folder, m_body));
+            return this;
+        }
+
     protected:
-        Vector<SharedPtr<Statement>> m_body;
+        Vector<Statement *> m_body;
     };
 
     class FunctionDeclaration : public Statement {
     public:
-        FunctionDeclaration(SharedPtr<Identifier> id,
-                            Vector<SharedPtr<Identifier>> params,
-                            SharedPtr<BlockStatement> body)
-                : m_body(body),
-                  m_id{id},
+        FunctionDeclaration(Identifier *id,
+                            Span<Identifier *> params,
+                            BlockStatement *body)
+                : m_id{id},
+                  m_body(body),
                   m_params{params},
                   m_async{false},
                   m_expression{false},
                   m_generator{false} {}
 
-        FunctionDeclaration(SharedPtr<Identifier> id,
-                            SharedPtr<BlockStatement> body)
-                : m_body(body),
-                  m_id(id),
+        FunctionDeclaration(Identifier *id,
+                            BlockStatement *body)
+                : m_id(id),
+                  m_body(body),
                   m_async{false},
                   m_expression{false},
                   m_generator{false} {}
 
-        virtual ~FunctionDeclaration() {
-            std::cout << "~FunctionDeclaration" << std::endl;
-        }
-
         virtual void print(int32_t indent) const override {
             printIndent(indent);
             std::cout << "[FunctionDeclaration]" << std::endl;
@@ -179,20 +458,173 @@ namespace LibJS {
             std::cout << "generator: " << (m_generator ? "true" : "false") << std::endl;
         }
 
+        virtual void serialize(ASTWriter &writer) const override {
+            writer.writeKind(NodeKind::FunctionDeclaration);
+            writer.writeNode(m_id);
+            writer.writeNodes(m_params);
+            writer.writeNode(m_body);
+        }
+
         virtual Value execute(Interpreter &interpreter) {
-            const auto name = m_id->name();
-            const auto fn = std::make_shared<Function>(name, m_body);
-            std::cout << fn->toString() << std::endl;
-            const auto functionValue = Value(fn);
-            std::cout << functionValue.toString() << std::endl;
-            interpreter.declareVariable(m_id->name(), functionValue);
+            const auto functionValue = createFunction(interpreter);
+            Log::trace(Log::Category::Interpreter, [&](std::ostream &out) {
+                out << "declared " << functionValue.toString();
+            });
+            interpreter.setVariable(m_id->location(), functionValue);
             return {};
         }
 
+        // The function closes over the environment of the frame that is currently executing.
+        Value createFunction(Interpreter &interpreter) {
+            return Value(interpreter.heap().allocate<Function>(m_id->name(), this,
+                                                               interpreter.currentStackFrame().environment()));
+        }
+
+        virtual Bytecode::Register generateBytecode(Bytecode::Generator &generator) override {
+            const auto reg = generator.allocateRegister();
+            generator.emit(Bytecode::OpCode::NewFunction, reg, generator.addFunction(this));
+            return m_id->generateStore(generator, reg);
+        }
+
+        // Compiled on first use, nullptr if the body uses something the bytecode doesn't support.
+        const Bytecode::Executable *bytecode() {
+            if (!m_bytecodeGenerated) {
+                const RuntimeStats::PhaseScope phase(RuntimeStats::Phase::Compilation);
+                Bytecode::Generator generator(m_layout.slotCount());
+                m_body->generateBytecode(generator);
+                m_bytecode = generator.finish();
+                m_bytecodeGenerated = true;
+                if (!m_bytecode) {
+                    Log::debug(Log::Category::Bytecode, [&](std::ostream &out) {
+                        out << m_id->name() << " uses something the bytecode doesn't support, it runs in the tree-walker";
+                    });
+                }
+            }
+            return m_bytecode ? &m_bytecode.value() : nullptr;
+        }
+
+        // Closure compiled on first use, like the bytecode.
+        const CompiledNode &compiledBody() {
+            if (!m_compiledBody) {
+                const RuntimeStats::PhaseScope phase(RuntimeStats::Phase::Compilation);
+                m_compiledBody = m_body->compile();
+            }
+            return m_compiledBody;
+        }
+
+        // Counts the calls and compiles the bytecode to machine code once the function is hot. nullptr until then,
+        // while the JIT is off and if it couldn't compile the function.
+        const JIT::Code *nativeCode(Interpreter &interpreter, const Bytecode::Executable &executable) {
+            if (!interpreter.isJitEnabled()) {
+                return nullptr;
+            }
+            if (!m_nativeCodeGenerated && ++m_callCount >= JIT::HotnessThreshold) {
+                const RuntimeStats::PhaseScope phase(RuntimeStats::Phase::Compilation);
+                m_nativeCode = JIT::compile(executable);
+                m_nativeCodeGenerated = true;
+                Log::debug(Log::Category::JIT, [&](std::ostream &out) {
+                    out << (m_nativeCode ? "compiled " : "could not compile ") << m_id->name();
+                });
+            }
+            return m_nativeCode ? &m_nativeCode.value() : nullptr;
+        }
+
+        BlockStatement *body() const { return m_body; }
+
+        // Calls the function with the arguments the caller pushed onto the value stack, running its bytecode if the
+        // interpreter is in bytecode mode and the body could be compiled, or its machine code once it is hot. In
+        // closure mode the compiled body runs, otherwise the tree-walker. A return completion ends here, a throw keeps
+        // unwinding into the caller. Tail calls replace the callee's frame and loop here instead of nesting, so tail
+        // recursion runs in constant C++ stack and frame space.
+        static Value call(Interpreter &interpreter, Function &function, int32_t argumentCount) {
+            FunctionDeclaration *declaration = function.declaration();
+            Environment *environment = function.environment();
+            for (;;) {
+                interpreter.stats().recordCall(declaration->layout().functionName());
+                const Bytecode::Executable *executable =
+                        interpreter.executionMode() == Interpreter::ExecutionMode::Bytecode ? declaration->bytecode()
+                                                                                          : nullptr;
+                const JIT::Code *nativeCode = executable ? declaration->nativeCode(interpreter, *executable) : nullptr;
+                if (!interpreter.pushStackFrame(declaration->layout(), environment, argumentCount,
+                                                executable ? executable->registerCount : 0)) {
+                    return {};
+                }
+                Value result;
+                if (nativeCode) {
+                    result = nativeCode->run(interpreter, *executable);
+                } else if (executable) {
+                    result = Bytecode::VM(interpreter).run(*executable);
+                } else if (interpreter.executionMode() == Interpreter::ExecutionMode::Closure) {
+                    result = declaration->compiledBody()(interpreter);
+                } else {
+                    result = declaration->m_body->execute(interpreter);
+                }
+                switch (interpreter.completion()) {
+                    case Completion::TailCall: {
+                        // The frame only needs the declaration and environment, not the function cell itself. The
+                        // environment stays reachable through the frame that is pushed next.
+                        Function *next = interpreter.clearCompletion().asFunction();
+                        argumentCount = interpreter.popStackFrameForTailCall();
+                        declaration = next->declaration();
+                        environment = next->environment();
+                        continue;
+                    }
+                    case Completion::Return:
+                        result = interpreter.clearCompletion();
+                        break;
+                    case Completion::Throw:
+                        result = {};
+                        break;
+                    default:
+                        break;
+                }
+                interpreter.popStackFrame();
+                return result;
+            }
+        }
+
+        const FrameLayout &layout() const { return m_layout; }
+
+        virtual void hoistDeclarations(ScopeAnalyzer &analyzer) override {
+            m_id->declare(analyzer);
+        }
+
+        virtual bool isFunctionDeclaration() const override { return true; }
+
+        // Parameters take the first slots of the function's frame, followed by its hoisted declarations. Captured
+        // parameters are still passed in their slot and copied into the environment once the frame is pushed.
+        virtual void analyzeScope(ScopeAnalyzer &analyzer) override {
+            analyzer.enterScope(m_layout);
+            m_layout.setFunctionName(m_id->name());
+            for (const auto &param : m_params) {
+                const int32_t slot = m_layout.slotCount();
+                param->declare(analyzer);
+                if (m_layout.slotCount() > slot && param->location().kind == VariableLocation::Kind::Environment) {
+                    m_layout.addCapturedParameter(slot, param->location().index);
+                }
+            }
+            m_layout.setParameterCount(m_layout.slotCount());
+            m_body->hoistDeclarations(analyzer);
+            m_body->analyzeScope(analyzer);
+            analyzer.leaveScope();
+        }
+
+        virtual Statement *foldConstants(ConstantFolder &folder) override {
+            m_body->foldConstants(folder);
+            return this;
+        }
+
     private:
-        SharedPtr<Identifier> m_id;
-        SharedPtr<BlockStatement> m_body;
-        Vector<SharedPtr<Identifier>> m_params;
+        Identifier *m_id;
+        BlockStatement *m_body;
+        Span<Identifier *> m_params;
+        FrameLayout m_layout;
+        Optional<Bytecode::Executable> m_bytecode;
+        bool m_bytecodeGenerated{false};
+        CompiledNode m_compiledBody;
+        uint32_t m_callCount{0};
+        Optional<JIT::Code> m_nativeCode;
+        bool m_nativeCodeGenerated{false};
         bool m_async;
         bool m_expression;
         bool m_generator;
@@ -202,7 +634,7 @@ namespace LibJS {
 
     };
 
-    class Program : public ScopeNode {
+    class Program final : public ScopeNode {
     public:
         enum class SourceType {
             Script,
@@ -211,6 +643,44 @@ namespace LibJS {
 
         explicit Program(SourceType type) : m_sourceType{type} {}
 
+        // Allocates a node in this program's arena. Nodes live exactly as long as the program.
+        template<typename T, typename... Args>
+        T *make(Args &&... args) {
+            return m_arena.make<T>(std::forward<Args>(args)...);
+        }
+
+        template<typename T, typename... Args>
+        T *append(Args &&... args) {
+            T *node = make<T>(std::forward<Args>(args)...);
+            ScopeNode::append(node);
+            return node;
+        }
+
+        using ScopeNode::append;
+
+        template<typename T>
+        Span<T> makeArray(std::initializer_list<T> elements) {
+            return m_arena.copyArray<T>(Span<const T>(elements.begin(), elements.size()));
+        }
+
+        template<typename T>
+        Span<T> makeArray(const Vector<T> &elements) {
+            return m_arena.copyArray<T>(Span<const T>(elements));
+        }
+
+        std::string_view copyString(std::string_view string) {
+            return m_arena.copyString(string);
+        }
+
+        // String literal cells live in the arena as well, the program keeps them alive instead of their refcount.
+        Value makeString(String string) {
+            auto *cell = m_arena.make<PrimitiveString>(std::move(string));
+            cell->makeImmortal();
+            return Value(cell);
+        }
+
+        const Arena &arena() const { return m_arena; }
+
         virtual void print(int32_t indent = 0) const override {
             printIndent(indent);
             std::cout << "[Program Node]" << std::endl;
@@ -221,8 +691,86 @@ namespace LibJS {
             ScopeNode::print(indent + 1);
         }
 
+        virtual void serialize(ASTWriter &writer) const override {
+            writer.writeKind(NodeKind::Program);
+            writer.writeUnsigned(static_cast<uint64_t>(m_sourceType));
+            writer.writeNodes(m_body);
+        }
+
+        // An uncaught exception leaves the Throw completion set, the caller reports it and takes the thrown value with
+        // clearCompletion().
+        virtual Value execute(Interpreter &interpreter) override {
+            if (!m_scopesAnalyzed) {
+                const RuntimeStats::PhaseScope phase(RuntimeStats::Phase::Analysis);
+                foldConstants();
+                analyzeScopes();
+            }
+            const RuntimeStats::PhaseScope phase(RuntimeStats::Phase::Execution);
+            Value result;
+            if (interpreter.executionMode() == Interpreter::ExecutionMode::Bytecode && bytecode()) {
+                interpreter.enterProgram(m_layout, bytecode()->registerCount);
+                result = Bytecode::VM(interpreter).run(*bytecode());
+            } else if (interpreter.executionMode() == Interpreter::ExecutionMode::Closure) {
+                if (!m_compiledBody) {
+                    const RuntimeStats::PhaseScope compilation(RuntimeStats::Phase::Compilation);
+                    m_compiledBody = compile();
+                }
+                interpreter.enterProgram(m_layout);
+                result = m_compiledBody(interpreter);
+            } else {
+                interpreter.enterProgram(m_layout);
+                result = ScopeNode::execute(interpreter);
+            }
+            return result;
+        }
+
+        const Bytecode::Executable *bytecode() {
+            if (!m_bytecodeGenerated) {
+                const RuntimeStats::PhaseScope phase(RuntimeStats::Phase::Compilation);
+                Bytecode::Generator generator(m_layout.slotCount());
+                generateBytecode(generator);
+                m_bytecode = generator.finish();
+                m_bytecodeGenerated = true;
+            }
+            return m_bytecode ? &m_bytecode.value() : nullptr;
+        }
+
+        // Program level variables are the slots of the global frame, see Interpreter::globalStackFrame.
+        const FrameLayout &layout() const { return m_layout; }
+
+        // Runs once before the scopes are analyzed, every later execution of the program profits from it.
+        void foldConstants() {
+            if (m_constantsFolded) {
+                return;
+            }
+            ConstantFolder folder(*this);
+            ScopeNode::foldConstants(folder);
+            m_constantsFolded = true;
+        }
+
+        // The first pass finds the captured variables, the second one moves them into environments and resolves
+        // every identifier to its final location.
+        void analyzeScopes() {
+            for (int32_t pass = 0; pass < 2; ++pass) {
+                ScopeAnalyzer analyzer;
+                analyzer.enterScope(m_layout);
+                hoistDeclarations(analyzer);
+                analyzeScope(analyzer);
+                analyzer.leaveScope();
+            }
+            m_scopesAnalyzed = true;
+        }
+
     private:
+        // Declared first so that it is destroyed last, after everything still referring to arena memory.
+        Arena m_arena;
         SourceType m_sourceType;
+        FrameLayout m_layout;
+        bool m_constantsFolded{false};
+        bool m_scopesAnalyzed{false};
+        Optional<Bytecode::Executable> m_bytecode;
+        bool m_bytecodeGenerated{false};
+        CompiledNode m_compiledBody;
     };
 
     class Literal : public Expression {
@@ -237,23 +785,61 @@ namespace LibJS {
             std::cout << "value: " << m_value.toString() << std::endl;
         }
 
+        virtual void serialize(ASTWriter &writer) const override {
+            writer.writeKind(NodeKind::Literal);
+            writer.writeValue(m_value);
+        }
+
         virtual Value execute(Interpreter &interpreter) override {
             return m_value;
         }
 
+        virtual Bytecode::Register generateBytecode(Bytecode::Generator &generator) override {
+            return generator.loadConstant(m_value);
+        }
+
+        virtual CompiledNode compile() override {
+            return [value = m_value](Interpreter &) { return value; };
+        }
+
+        virtual bool isPure() const override { return true; }
+
+        const Value &value() const { return m_value; }
+
     private:
         Value m_value;
     };
 
+    inline Literal *ConstantFolder::makeLiteral(const Value &value) {
+        if (value.isString()) {
+            return m_program.make<Literal>(m_program.makeString(value.asString()));
+        }
+        return m_program.make<Literal>(value);
+    }
+
+    inline Statement *ConstantFolder::makeEmptyStatement() {
+        return m_program.make<BlockStatement>(Span<Statement *>());
+    }
+
+    // Hoists into a throwaway scope. The locations this assigns are overwritten once the program is analyzed.
+    inline bool ConstantFolder::declaresNames(Statement *statement) {
+        FrameLayout layout;
+        ScopeAnalyzer analyzer;
+        analyzer.enterScope(layout);
+        statement->hoistDeclarations(analyzer);
+        analyzer.leaveScope();
+        return layout.slotCount() > 0;
+    }
+
 
     class CallExpression : public Expression {
     public:
-        CallExpression(UniquePtr<Expression> callee, Vector<SharedPtr<Expression>> &&arguments)
-                : m_callee{std::move(callee)},
+        CallExpression(Expression *callee, Span<Expression *> arguments)
+                : m_callee{callee},
                   m_arguments{arguments} {}
 
-        CallExpression(UniquePtr<Expression> callee)
-                : m_callee{std::move(callee)} {}
+        CallExpression(Expression *callee)
+                : m_callee{callee} {}
 
         virtual void print(int32_t indent) const override {
             printIndent(indent);
@@ -272,74 +858,361 @@ namespace LibJS {
             }
         }
 
+        virtual void serialize(ASTWriter &writer) const override {
+            writer.writeKind(NodeKind::CallExpression);
+            writer.writeNode(m_callee);
+            writer.writeNodes(m_arguments);
+        }
+
         virtual Value execute(Interpreter &interpreter) {
-            Vector<Value> argumentValues;
-            for (const auto &args : m_arguments) {
-                argumentValues.emplace_back(args->execute(interpreter));
+            const Value callee = evaluateCallee(interpreter);
+            if (interpreter.isUnwinding()) {
+                return {};
+            }
+            TemporaryRoot calleeRoot(interpreter, callee);
+            if (!pushArguments(interpreter) || !checkCallable(interpreter, callee)) {
+                return {};
+            }
+            return FunctionDeclaration::call(interpreter, *callee.asFunction(), argumentCount());
+        }
+
+        // Used by a return in tail position: instead of calling, the arguments are left on the value stack and the
+        // caller's FunctionDeclaration::call replaces the current frame with the callee's.
+        void executeTailCall(Interpreter &interpreter) {
+            const Value callee = evaluateCallee(interpreter);
+            if (interpreter.isUnwinding()) {
+                return;
             }
-            if (const Identifier *identifier = dynamic_cast<Identifier *>(m_callee.get())) {
-                interpreter.pushStackFrame();
+            TemporaryRoot calleeRoot(interpreter, callee);
+            if (pushArguments(interpreter) && checkCallable(interpreter, callee)) {
+                interpreter.tailCall(callee, argumentCount());
+            }
+        }
 
-                auto functionToCall = interpreter.getVariable(identifier->name());
-                assert(functionToCall.has_value());
+        virtual void analyzeScope(ScopeAnalyzer &analyzer) override {
+            m_callee->analyzeScope(analyzer);
+            for (const auto &argument : m_arguments) {
+                argument->analyzeScope(analyzer);
+            }
+        }
 
-                auto function = functionToCall.value().asFunction();
+        virtual Expression *foldConstants(ConstantFolder &folder) override {
+            m_callee = m_callee->foldConstants(folder);
+            for (auto &argument : m_arguments) {
+                argument = argument->foldConstants(folder);
+            }
+            return this;
+        }
 
-                Value calleeReturnValue = functionToCall.value().asFunction()->body()->execute(interpreter);
+        virtual Bytecode::Register generateBytecode(Bytecode::Generator &generator) override {
+            return generateCall(generator, Bytecode::OpCode::Call);
+        }
 
-                interpreter.popStackFrame();
-                return calleeReturnValue;
+        virtual CompiledNode compile() override {
+            return compileCall(false);
+        }
 
-            } else {
-                assert(false);
+        // A tail call leaves the arguments on the value stack, like executeTailCall. Any callee expression can be
+        // compiled, see evaluateCallee.
+        CompiledNode compileCall(bool tailCall) {
+            Vector<CompiledNode> arguments;
+            arguments.reserve(m_arguments.size());
+            for (const auto &argument : m_arguments) {
+                arguments.push_back(argument->compile());
+            }
+            return [callee = m_callee->compile(), arguments = std::move(arguments), tailCall](
+                    Interpreter &interpreter) {
+                const Value function = callee(interpreter);
+                if (interpreter.isUnwinding()) {
+                    return Value();
+                }
+                TemporaryRoot functionRoot(interpreter, function);
+                const auto argumentCount = static_cast<int32_t>(arguments.size());
+                for (int32_t i = 0; i < argumentCount; ++i) {
+                    const Value argument = arguments[i](interpreter);
+                    if (interpreter.isUnwinding() || !interpreter.pushArgument(argument)) {
+                        interpreter.popArguments(i);
+                        return Value();
+                    }
+                }
+                if (!function.isFunction()) {
+                    interpreter.popArguments(argumentCount);
+                    interpreter.checkCallable(function);
+                    return Value();
+                }
+                if (tailCall) {
+                    interpreter.tailCall(function, argumentCount);
+                    return Value();
+                }
+                return FunctionDeclaration::call(interpreter, *function.asFunction(), argumentCount);
+            };
+        }
+
+        // Arguments are evaluated into consecutive registers following the callee.
+        Bytecode::Register generateCall(Bytecode::Generator &generator, Bytecode::OpCode opcode) {
+            if (m_arguments.size() > std::numeric_limits<uint8_t>::max()) {
+                generator.unsupported();
+                return 0;
+            }
+            auto callee = m_callee->generateBytecode(generator);
+            if (generator.isVariable(callee) && !m_arguments.empty()) {
+                const auto copy = generator.allocateRegister();
+                generator.emit(Bytecode::OpCode::Move, copy, callee);
+                callee = copy;
+            }
+            const auto firstArgument = generator.registerMark();
+            for (size_t i = 0; i < m_arguments.size(); ++i) {
+                generator.allocateRegister();
+            }
+            for (size_t i = 0; i < m_arguments.size(); ++i) {
+                const auto argumentRegister = static_cast<Bytecode::Register>(firstArgument + i);
+                const auto value = m_arguments[i]->generateBytecode(generator);
+                if (value != argumentRegister) {
+                    generator.emit(Bytecode::OpCode::Move, argumentRegister, value);
+                }
             }
+            const auto result = generator.allocateRegister();
+            generator.emit(opcode, result, callee, firstArgument, static_cast<uint8_t>(m_arguments.size()));
+            return result;
         }
 
     private:
-        UniquePtr<Expression> m_callee;
-        Vector<SharedPtr<Expression>> m_arguments;
+        // Any expression can be called, like a member `o.f()` or the result of another call `f()()`. Functions don't
+        // have a `this` binding yet, so the object of a member callee is only evaluated for its property.
+        Value evaluateCallee(Interpreter &interpreter) const {
+            return m_callee->execute(interpreter);
+        }
+
+        int32_t argumentCount() const { return static_cast<int32_t>(m_arguments.size()); }
+
+        // Like in the bytecode, the callee is only checked once the arguments are evaluated. A callee that isn't a
+        // function drops the pushed arguments and throws a TypeError.
+        bool checkCallable(Interpreter &interpreter, const Value &callee) const {
+            if (callee.isFunction()) {
+                return true;
+            }
+            interpreter.popArguments(argumentCount());
+            return interpreter.checkCallable(callee);
+        }
+
+        // Arguments are evaluated straight into the callee's parameter slots, the value stack roots them. Returns
+        // false if evaluating one of them threw.
+        bool pushArguments(Interpreter &interpreter) {
+            for (int32_t i = 0; i < argumentCount(); ++i) {
+                const Value argument = m_arguments[i]->execute(interpreter);
+                if (interpreter.isUnwinding() || !interpreter.pushArgument(argument)) {
+                    interpreter.popArguments(i);
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        Expression *m_callee;
+        Span<Expression *> m_arguments;
     };
 
-    class BinaryExpression : public Expression {
+    class Property : public ASTNode {
     public:
-        enum class BinaryOperator {
-            Add,
-            Subtract,
-            Divide,
-            Multiply,
-            Modulo,
-            Power,
-            BitwiseAnd,
-            BitwiseOr,
-            BitwiseXor,
-            LeftShift,
-            RightShift,
-            Equal,
-            NotEqual,
-            GreaterThanOrEqual,
-            GreaterThan,
-            LessThan,
-            LessThanOrEqual
-        };
-
-        BinaryExpression(BinaryOperator op, UniquePtr<Expression> left, UniquePtr<Expression> right)
-                : m_operator{op},
-                  m_left{std::move(left)},
-                  m_right{std::move(right)} {}
+        Property(Atom key, Expression *value)
+                : m_key{key},
+                  m_value{value},
+                  m_cache{key} {}
 
         virtual void print(int32_t indent) const override {
             printIndent(indent);
-            std::cout << "[BinaryExpression]" << std::endl;
-
+            std::cout << "[Property]" << std::endl;
             printIndent(indent + 1);
-            std::cout << "operator: ";
-            switch (m_operator) {
-                case BinaryOperator::Add:
-                    std::cout << "+" << std::endl;
-                    break;
-                case BinaryOperator::Subtract:
-                    std::cout << "-" << std::endl;
-                    break;
+            std::cout << "key: " << m_key << std::endl;
+            printIndent(indent + 1);
+            std::cout << "value: " << std::endl;
+            m_value->print(indent + 2);
+        }
+
+        virtual void serialize(ASTWriter &writer) const override {
+            writer.writeKind(NodeKind::Property);
+            writer.writeAtom(m_key);
+            writer.writeNode(m_value);
+        }
+
+        virtual void analyzeScope(ScopeAnalyzer &analyzer) override {
+            m_value->analyzeScope(analyzer);
+        }
+
+        void foldConstants(ConstantFolder &folder) {
+            m_value = m_value->foldConstants(folder);
+        }
+
+        Expression *value() const { return m_value; }
+
+        // Every literal evaluated at this site adds the same keys in the same order, so stores hit the cache.
+        PropertyCache &cache() { return m_cache; }
+
+    private:
+        Atom m_key;
+        Expression *m_value;
+        PropertyCache m_cache;
+    };
+
+    class ObjectExpression : public Expression {
+    public:
+        ObjectExpression(Span<Property *> properties)
+                : m_properties{properties} {}
+
+        virtual void print(int32_t indent) const override {
+            printIndent(indent);
+            std::cout << "[ObjectExpression]" << std::endl;
+            printIndent(indent + 1);
+            std::cout << "properties: " << std::endl;
+            for (const auto &property : m_properties) {
+                property->print(indent + 2);
+            }
+        }
+
+        virtual void serialize(ASTWriter &writer) const override {
+            writer.writeKind(NodeKind::ObjectExpression);
+            writer.writeNodes(m_properties);
+        }
+
+        virtual Value execute(Interpreter &interpreter) override {
+            Object *object = interpreter.createObject();
+            const Value value(object);
+            TemporaryRoot objectRoot(interpreter, value);
+            for (const auto &property : m_properties) {
+                const Value propertyValue = property->value()->execute(interpreter);
+                if (interpreter.isUnwinding()) {
+                    return {};
+                }
+                property->cache().put(*object, propertyValue);
+            }
+            return value;
+        }
+
+        virtual void analyzeScope(ScopeAnalyzer &analyzer) override {
+            for (const auto &property : m_properties) {
+                property->analyzeScope(analyzer);
+            }
+        }
+
+        virtual Expression *foldConstants(ConstantFolder &folder) override {
+            for (const auto &property : m_properties) {
+                property->foldConstants(folder);
+            }
+            return this;
+        }
+
+        virtual Bytecode::Register generateBytecode(Bytecode::Generator &generator) override {
+            const auto object = generator.allocateRegister();
+            generator.emit(Bytecode::OpCode::NewObject, object);
+            for (const auto &property : m_properties) {
+                const auto value = property->value()->generateBytecode(generator);
+                generator.emit(Bytecode::OpCode::PutProperty, value, object,
+                               generator.addPropertyCache(&property->cache()));
+            }
+            return object;
+        }
+
+    private:
+        Span<Property *> m_properties;
+    };
+
+    // Only the non computed form, object.property.
+    class MemberExpression : public Expression {
+    public:
+        MemberExpression(Expression *object, Atom property)
+                : m_object{object},
+                  m_property{property},
+                  m_cache{property} {}
+
+        virtual void print(int32_t indent) const override {
+            printIndent(indent);
+            std::cout << "[MemberExpression]" << std::endl;
+            printIndent(indent + 1);
+            std::cout << "object: " << std::endl;
+            m_object->print(indent + 2);
+            printIndent(indent + 1);
+            std::cout << "property: " << m_property << std::endl;
+        }
+
+        virtual void serialize(ASTWriter &writer) const override {
+            writer.writeKind(NodeKind::MemberExpression);
+            writer.writeNode(m_object);
+            writer.writeAtom(m_property);
+        }
+
+        virtual Value execute(Interpreter &interpreter) override {
+            return getFrom(m_object->execute(interpreter));
+        }
+
+        // Primitives have no properties yet, reading from them yields undefined and writes are dropped.
+        Value getFrom(const Value &object) {
+            if (!object.isObject()) {
+                return {};
+            }
+            return m_cache.get(*object.asObject());
+        }
+
+        void putInto(const Value &object, const Value &value) {
+            if (object.isObject()) {
+                m_cache.put(*object.asObject(), value);
+            }
+        }
+
+        virtual void analyzeScope(ScopeAnalyzer &analyzer) override {
+            m_object->analyzeScope(analyzer);
+        }
+
+        virtual Expression *foldConstants(ConstantFolder &folder) override {
+            m_object = m_object->foldConstants(folder);
+            return this;
+        }
+
+        virtual Bytecode::Register generateBytecode(Bytecode::Generator &generator) override {
+            const auto object = m_object->generateBytecode(generator);
+            const auto result = generator.allocateRegister();
+            generator.emit(Bytecode::OpCode::GetProperty, result, object, generator.addPropertyCache(&m_cache));
+            return result;
+        }
+
+        virtual CompiledNode compile() override {
+            return [object = m_object->compile(), this](Interpreter &interpreter) {
+                return getFrom(object(interpreter));
+            };
+        }
+
+        Expression *object() const { return m_object; }
+
+        // Loads and stores of this site share the cache, in the AST interpreter as well as in the bytecode.
+        PropertyCache &cache() { return m_cache; }
+
+    private:
+        Expression *m_object;
+        Atom m_property;
+        PropertyCache m_cache;
+    };
+
+    class BinaryExpression : public Expression {
+    public:
+        using BinaryOperator = LibJS::BinaryOperator;
+
+        BinaryExpression(BinaryOperator op, Expression *left, Expression *right)
+                : m_operation{op},
+                  m_left{left},
+                  m_right{right} {}
+
+        virtual void print(int32_t indent) const override {
+            printIndent(indent);
+            std::cout << "[BinaryExpression]" << std::endl;
+
+            printIndent(indent + 1);
+            std::cout << "operator: ";
+            switch (m_operation.op()) {
+                case BinaryOperator::Add:
+                    std::cout << "+" << std::endl;
+                    break;
+                case BinaryOperator::Subtract:
+                    std::cout << "-" << std::endl;
+                    break;
                 case BinaryOperator::Divide:
                     std::cout << "/" << std::endl;
                     break;
@@ -399,37 +1272,88 @@ namespace LibJS {
             }
         }
 
+        virtual void serialize(ASTWriter &writer) const override {
+            writer.writeKind(NodeKind::BinaryExpression);
+            writer.writeUnsigned(static_cast<uint64_t>(m_operation.op()));
+            writer.writeNode(m_left);
+            writer.writeNode(m_right);
+        }
+
         virtual Value execute(Interpreter &interpreter) override {
-            const Value &valueLeft = m_left->execute(interpreter);
-            const Value &valueRight = m_right->execute(interpreter);
+            const Value valueLeft = m_left->execute(interpreter);
+            if (interpreter.isUnwinding()) {
+                return {};
+            }
+            TemporaryRoot leftRoot(interpreter, valueLeft);
+            const Value valueRight = m_right->execute(interpreter);
+            if (interpreter.isUnwinding()) {
+                return {};
+            }
+            return m_operation.execute(valueLeft, valueRight);
+        }
 
-            switch (m_operator) {
-                case BinaryOperator::Multiply:
-                    return multiply(valueLeft, valueRight);
-                case BinaryOperator::Divide:
-                    return divide(valueLeft, valueRight);
-                case BinaryOperator::Add:
-                    return add(valueLeft, valueRight);
-                case BinaryOperator::Subtract:
-                    return subtract(valueLeft, valueRight);
-                case BinaryOperator::GreaterThan:
-                    return greaterThan(valueLeft, valueRight);
-                default:
-                    assert(false);
-                    break;
+        // The generic operator, used for constant folding so it doesn't feed the site's type feedback.
+        Value evaluate(const Value &valueLeft, const Value &valueRight) const {
+            return binaryOperation(m_operation.op(), valueLeft, valueRight);
+        }
+
+        virtual void analyzeScope(ScopeAnalyzer &analyzer) override {
+            m_left->analyzeScope(analyzer);
+            m_right->analyzeScope(analyzer);
+        }
+
+        virtual Expression *foldConstants(ConstantFolder &folder) override {
+            m_left = m_left->foldConstants(folder);
+            m_right = m_right->foldConstants(folder);
+            const auto *left = dynamic_cast<Literal *>(m_left);
+            const auto *right = dynamic_cast<Literal *>(m_right);
+            if (!left || !right) {
+                return this;
+            }
+            return folder.makeLiteral(evaluate(left->value(), right->value()));
+        }
+
+        virtual Bytecode::Register generateBytecode(Bytecode::Generator &generator) override {
+            const auto opcode = Bytecode::binaryOpCode(m_operation.op());
+            auto left = m_left->generateBytecode(generator);
+            if (generator.isVariable(left) && !m_right->isPure()) {
+                const auto copy = generator.allocateRegister();
+                generator.emit(Bytecode::OpCode::Move, copy, left);
+                left = copy;
             }
+            const auto right = m_right->generateBytecode(generator);
+            const auto result = generator.allocateRegister();
+            generator.emit(opcode, result, left, right);
+            return result;
+        }
+
+        // Shares the site's operator, and with it the type feedback, with the tree-walker.
+        virtual CompiledNode compile() override {
+            return [left = m_left->compile(), right = m_right->compile(), operation = &m_operation](
+                    Interpreter &interpreter) {
+                const Value valueLeft = left(interpreter);
+                if (interpreter.isUnwinding()) {
+                    return Value();
+                }
+                TemporaryRoot leftRoot(interpreter, valueLeft);
+                const Value valueRight = right(interpreter);
+                if (interpreter.isUnwinding()) {
+                    return Value();
+                }
+                return operation->execute(valueLeft, valueRight);
+            };
         }
 
     private:
-        BinaryOperator m_operator;
-        UniquePtr<Expression> m_left;
-        UniquePtr<Expression> m_right;
+        SpecializingOperator m_operation;
+        Expression *m_left;
+        Expression *m_right;
     };
 
     class ExpressionStatement : public Statement {
     public:
-        ExpressionStatement(UniquePtr<Expression> expression)
-                : m_expression{std::move(expression)} {}
+        ExpressionStatement(Expression *expression)
+                : m_expression{expression} {}
 
         virtual void print(int32_t indent) const override {
             printIndent(indent);
@@ -440,20 +1364,43 @@ namespace LibJS {
             m_expression->print(indent + 2);
         }
 
+        virtual void serialize(ASTWriter &writer) const override {
+            writer.writeKind(NodeKind::ExpressionStatement);
+            writer.writeNode(m_expression);
+        }
+
         virtual Value execute(Interpreter &interpreter) {
             return m_expression->execute(interpreter);
         }
 
+        virtual void analyzeScope(ScopeAnalyzer &analyzer) override {
+            m_expression->analyzeScope(analyzer);
+        }
+
+        virtual Bytecode::Register generateBytecode(Bytecode::Generator &generator) override {
+            return m_expression->generateBytecode(generator);
+        }
+
+        virtual CompiledNode compile() override {
+            return m_expression->compile();
+        }
+
+        // Nobody uses the value of an expression statement, so a pure one doesn't need to run at all.
+        virtual Statement *foldConstants(ConstantFolder &folder) override {
+            m_expression = m_expression->foldConstants(folder);
+            return m_expression->isPure() ? nullptr : this;
+        }
+
     private:
-        UniquePtr<Expression> m_expression;
+        Expression *m_expression;
     };
 
     class VariableDeclarator : public ASTNode {
     public:
 
-        VariableDeclarator(UniquePtr<Expression> id, UniquePtr<Expression> init)
-                : m_id{std::move(id)},
-                  m_init{std::move(init)} {}
+        VariableDeclarator(Expression *id, Expression *init)
+                : m_id{id},
+                  m_init{init} {}
 
         virtual void print(int32_t indent) const override {
             printIndent(indent);
@@ -466,13 +1413,29 @@ namespace LibJS {
             m_init->print(indent + 2);
         }
 
+        virtual void serialize(ASTWriter &writer) const override {
+            writer.writeKind(NodeKind::VariableDeclarator);
+            writer.writeNode(m_id);
+            writer.writeNode(m_init);
+        }
+
         virtual Value execute(Interpreter &interpreter) override {
             return m_init->execute(interpreter);
         }
 
+        virtual void hoistDeclarations(ScopeAnalyzer &analyzer) override {
+            if (auto *identifier = dynamic_cast<Identifier *>(m_id)) {
+                identifier->declare(analyzer);
+            }
+        }
+
+        virtual void analyzeScope(ScopeAnalyzer &analyzer) override {
+            m_init->analyzeScope(analyzer);
+        }
+
     public:
-        UniquePtr<Expression> m_id;
-        UniquePtr<Expression> m_init;
+        Expression *m_id;
+        Expression *m_init;
     };
 
     class VariableDeclaration : public Statement {
@@ -483,24 +1446,72 @@ namespace LibJS {
             Let,
         };
 
-        virtual ~VariableDeclaration() {
-            std::cout << "~VariableDeclaration" << std::endl;
-        }
-
-        VariableDeclaration(Kind kind, Vector<SharedPtr<VariableDeclarator>> &&declarators)
-                : m_kind{kind},
-                  m_declarators{std::move(declarators)} {}
+        VariableDeclaration(Kind kind, Span<VariableDeclarator *> declarators)
+                : m_declarators{declarators},
+                  m_kind{kind} {}
 
         virtual Value execute(Interpreter &interpreter) override {
             for (const auto &dec : m_declarators) {
-                if (const Identifier *identifier = dynamic_cast<Identifier *>(dec->m_id.get())) {
+                if (const Identifier *identifier = dynamic_cast<Identifier *>(dec->m_id)) {
                     const auto &value = dec->execute(interpreter);
-                    interpreter.declareVariable(identifier->name(), value);
+                    if (interpreter.isUnwinding()) {
+                        break;
+                    }
+                    interpreter.setVariable(identifier->location(), value);
                 } else {
                     assert(false); // Id Expression not supported
                 }
-                return {};
             }
+            return {};
+        }
+
+        virtual void hoistDeclarations(ScopeAnalyzer &analyzer) override {
+            for (const auto &dec : m_declarators) {
+                dec->hoistDeclarations(analyzer);
+            }
+        }
+
+        virtual void analyzeScope(ScopeAnalyzer &analyzer) override {
+            for (const auto &dec : m_declarators) {
+                dec->analyzeScope(analyzer);
+            }
+        }
+
+        virtual Statement *foldConstants(ConstantFolder &folder) override {
+            for (const auto &dec : m_declarators) {
+                dec->m_init = dec->m_init->foldConstants(folder);
+            }
+            return this;
+        }
+
+        virtual Bytecode::Register generateBytecode(Bytecode::Generator &generator) override {
+            for (const auto &dec : m_declarators) {
+                if (const Identifier *identifier = dynamic_cast<Identifier *>(dec->m_id)) {
+                    identifier->generateStore(generator, dec->m_init->generateBytecode(generator));
+                } else {
+                    generator.unsupported();
+                }
+            }
+            return 0;
+        }
+
+        virtual CompiledNode compile() override {
+            Vector<Pair<CompiledStore, CompiledNode>> declarators;
+            for (const auto &dec : m_declarators) {
+                const Identifier *identifier = dynamic_cast<Identifier *>(dec->m_id);
+                assert(identifier); // Id Expression not supported
+                declarators.emplace_back(identifier->compileStore(), dec->m_init->compile());
+            }
+            return [declarators = std::move(declarators)](Interpreter &interpreter) {
+                for (const auto &[store, init] : declarators) {
+                    const Value value = init(interpreter);
+                    if (interpreter.isUnwinding()) {
+                        break;
+                    }
+                    store(interpreter, value);
+                }
+                return Value();
+            };
         }
 
         virtual void print(int32_t indent) const override {
@@ -515,15 +1526,23 @@ namespace LibJS {
             }
         }
 
+        virtual void serialize(ASTWriter &writer) const override {
+            writer.writeKind(NodeKind::VariableDeclaration);
+            writer.writeUnsigned(static_cast<uint64_t>(m_kind));
+            writer.writeNodes(m_declarators);
+        }
+
     private:
-        Vector<SharedPtr<VariableDeclarator>> m_declarators;
+        Span<VariableDeclarator *> m_declarators;
         Kind m_kind;
     };
 
     class ReturnStatement : public Statement {
     public:
-        ReturnStatement(UniquePtr<Expression> argument)
-                : m_argument{std::move(argument)} {}
+        // The parser knows whether the return is in tail position, which isn't the case inside of try statements.
+        ReturnStatement(Expression *argument, bool tailPosition = false)
+                : m_argument{argument},
+                  m_tailPosition{tailPosition} {}
 
         virtual void print(int32_t indent) const override {
             printIndent(indent);
@@ -531,16 +1550,67 @@ namespace LibJS {
             printIndent(indent + 1);
             std::cout << "argument: " << std::endl;
             m_argument->print(indent + 2);
+            if (m_tailPosition) {
+                printIndent(indent + 1);
+                std::cout << "tailPosition: true" << std::endl;
+            }
+        }
+
+        virtual void serialize(ASTWriter &writer) const override {
+            writer.writeKind(NodeKind::ReturnStatement);
+            writer.writeNode(m_argument);
+            writer.writeBool(m_tailPosition);
         }
 
         virtual Value execute(Interpreter &interpreter) override {
+            if (m_tailCall) {
+                m_tailCall->executeTailCall(interpreter);
+                return {};
+            }
             const auto &value = m_argument->execute(interpreter);
-            interpreter.returnFromStackFrame(value);
+            if (!interpreter.isUnwinding()) {
+                interpreter.returnFromStackFrame(value);
+            }
             return value;
         }
 
+        // Analysis runs after folding, which may have replaced the argument.
+        virtual void analyzeScope(ScopeAnalyzer &analyzer) override {
+            m_argument->analyzeScope(analyzer);
+            m_tailCall = m_tailPosition ? dynamic_cast<CallExpression *>(m_argument) : nullptr;
+        }
+
+        virtual Statement *foldConstants(ConstantFolder &folder) override {
+            m_argument = m_argument->foldConstants(folder);
+            return this;
+        }
+
+        virtual Bytecode::Register generateBytecode(Bytecode::Generator &generator) override {
+            if (m_tailCall) {
+                return m_tailCall->generateCall(generator, Bytecode::OpCode::TailCall);
+            }
+            const auto value = m_argument->generateBytecode(generator);
+            generator.emit(Bytecode::OpCode::Return, value);
+            return value;
+        }
+
+        virtual CompiledNode compile() override {
+            if (m_tailCall) {
+                return m_tailCall->compileCall(true);
+            }
+            return [argument = m_argument->compile()](Interpreter &interpreter) {
+                const Value value = argument(interpreter);
+                if (!interpreter.isUnwinding()) {
+                    interpreter.returnFromStackFrame(value);
+                }
+                return value;
+            };
+        }
+
     private:
-        UniquePtr<Expression> m_argument;
+        Expression *m_argument;
+        bool m_tailPosition;
+        CallExpression *m_tailCall{nullptr};
     };
 
 
@@ -556,12 +1626,17 @@ namespace LibJS {
             Decrement,
         };
 
+        // Increments and decrements are compound assignments with a right side of 1, `postfix` makes them evaluate to
+        // the old value.
         AssignmentExpression(AssignmentOperator op,
-                             UniquePtr<Expression> left,
-                             UniquePtr<Expression> right)
+                             Expression *left,
+                             Expression *right,
+                             bool postfix = false)
                 : m_operator{op},
-                  m_left{std::move(left)},
-                  m_right{std::move(right)} {}
+                  m_left{left},
+                  m_right{right},
+                  m_operation{compoundOperator(op).value_or(BinaryOperator::Add)},
+                  m_postfix{postfix} {}
 
         virtual void print(int32_t indent) const override {
             printIndent(indent);
@@ -595,6 +1670,10 @@ namespace LibJS {
                     assert(false);
                     break;
             }
+            if (m_postfix) {
+                printIndent(indent + 1);
+                std::cout << "postfix: true" << std::endl;
+            }
 
             printIndent(indent + 1);
             std::cout << "left: " << std::endl;
@@ -606,64 +1685,276 @@ namespace LibJS {
             m_right->print(indent + 2);
         }
 
+        virtual void serialize(ASTWriter &writer) const override {
+            writer.writeKind(NodeKind::AssignmentExpression);
+            writer.writeUnsigned(static_cast<uint64_t>(m_operator));
+            writer.writeNode(m_left);
+            writer.writeNode(m_right);
+            writer.writeBool(m_postfix);
+        }
+
         virtual Value execute(Interpreter &interpreter) override {
-            if (const Identifier *identifier = dynamic_cast<Identifier *>(m_left.get())) {
-                switch (m_operator) {
-                    case AssignmentOperator::Assignment: {
-                        interpreter.setVariable(identifier->name(), m_right->execute(interpreter));
-                        break;
-                    }
-                    case AssignmentOperator::AdditionAssignment: {
-                        const Value &addedValue = add(m_left->execute(interpreter), m_right->execute(interpreter));
-                        interpreter.setVariable(identifier->name(), addedValue);
-                        break;
+            if (auto *member = dynamic_cast<MemberExpression *>(m_left)) {
+                const Value object = member->object()->execute(interpreter);
+                if (interpreter.isUnwinding()) {
+                    return {};
+                }
+                TemporaryRoot objectRoot(interpreter, object);
+                if (m_operator == AssignmentOperator::Assignment) {
+                    const Value value = m_right->execute(interpreter);
+                    if (interpreter.isUnwinding()) {
+                        return {};
                     }
-                    case AssignmentOperator::SubtractionAssignment: {
-                        const Value &subtractedValue = subtract(m_left->execute(interpreter),
-                                                                m_right->execute(interpreter));
-                        interpreter.setVariable(identifier->name(), subtractedValue);
-                        break;
+                    member->putInto(object, value);
+                    return value;
+                }
+                const Value current = member->getFrom(object);
+                TemporaryRoot currentRoot(interpreter, current);
+                const Value right = m_right->execute(interpreter);
+                if (interpreter.isUnwinding()) {
+                    return {};
+                }
+                const Value result = applyOperator(current, right);
+                member->putInto(object, result);
+                return resultOf(current, result);
+            }
+            const Identifier *identifier = dynamic_cast<Identifier *>(m_left);
+            assert(identifier);
+            if (m_operator == AssignmentOperator::Assignment) {
+                const Value value = m_right->execute(interpreter);
+                if (interpreter.isUnwinding()) {
+                    return {};
+                }
+                return interpreter.setVariable(identifier->location(), value);
+            }
+            // The left side is read first, and has to survive the evaluation of the right one.
+            const Value left = m_left->execute(interpreter);
+            TemporaryRoot leftRoot(interpreter, left);
+            const Value right = m_right->execute(interpreter);
+            if (interpreter.isUnwinding()) {
+                return {};
+            }
+            const Value result = applyOperator(left, right);
+            interpreter.setVariable(identifier->location(), result);
+            return resultOf(left, result);
+        }
+
+        virtual void analyzeScope(ScopeAnalyzer &analyzer) override {
+            if (auto *identifier = dynamic_cast<Identifier *>(m_left)) {
+                identifier->analyzeAssignmentTarget(analyzer);
+            } else {
+                m_left->analyzeScope(analyzer);
+            }
+            m_right->analyzeScope(analyzer);
+        }
+
+        // The target stays as it is, only the object of a member target is an ordinary expression.
+        virtual Expression *foldConstants(ConstantFolder &folder) override {
+            if (auto *member = dynamic_cast<MemberExpression *>(m_left)) {
+                member->foldConstants(folder);
+            }
+            m_right = m_right->foldConstants(folder);
+            return this;
+        }
+
+        // The identifier is resolved here once, the bytecode only refers to its register or slot.
+        virtual Bytecode::Register generateBytecode(Bytecode::Generator &generator) override {
+            if (auto *member = dynamic_cast<MemberExpression *>(m_left)) {
+                return generateMemberAssignment(generator, *member);
+            }
+            const Identifier *identifier = dynamic_cast<Identifier *>(m_left);
+            if (!identifier) {
+                generator.unsupported();
+                return 0;
+            }
+
+            if (m_operator == AssignmentOperator::Assignment) {
+                return identifier->generateStore(generator, m_right->generateBytecode(generator));
+            }
+            const auto opcode = compoundOpcode();
+            if (!opcode) {
+                generator.unsupported();
+                return 0;
+            }
+
+            auto left = m_left->generateBytecode(generator);
+            const bool leftIsVariable = generator.isVariable(left);
+            if (leftIsVariable && !m_right->isPure()) {
+                const auto copy = generator.allocateRegister();
+                generator.emit(Bytecode::OpCode::Move, copy, left);
+                left = copy;
+            }
+            const auto old = generateOldValue(generator, left);
+            const auto right = m_right->generateBytecode(generator);
+            if (leftIsVariable && identifier->location().isLocal() && left == identifier->location().index) {
+                generator.emit(*opcode, left, left, right);
+                return old.value_or(left);
+            }
+            const auto result = generator.allocateRegister();
+            generator.emit(*opcode, result, left, right);
+            const auto stored = identifier->generateStore(generator, result);
+            return old.value_or(stored);
+        }
+
+        // The kind of target and of assignment are decided here once, not on every execution.
+        virtual CompiledNode compile() override {
+            if (auto *member = dynamic_cast<MemberExpression *>(m_left)) {
+                return compileMemberAssignment(*member);
+            }
+            Identifier *identifier = dynamic_cast<Identifier *>(m_left);
+            assert(identifier);
+            if (m_operator == AssignmentOperator::Assignment) {
+                return [store = identifier->compileStore(), right = m_right->compile()](Interpreter &interpreter) {
+                    const Value value = right(interpreter);
+                    if (interpreter.isUnwinding()) {
+                        return Value();
                     }
-                    case AssignmentOperator::DivisionAssignment: {
-                        const Value &value = divide(m_left->execute(interpreter),
-                                                    m_right->execute(interpreter));
-                        interpreter.setVariable(identifier->name(), value);
-                        break;
+                    store(interpreter, value);
+                    return value;
+                };
+            }
+            return [load = identifier->compile(), store = identifier->compileStore(), right = m_right->compile(),
+                    this](Interpreter &interpreter) {
+                const Value left = load(interpreter);
+                TemporaryRoot leftRoot(interpreter, left);
+                const Value valueRight = right(interpreter);
+                if (interpreter.isUnwinding()) {
+                    return Value();
+                }
+                const Value result = applyOperator(left, valueRight);
+                store(interpreter, result);
+                return resultOf(left, result);
+            };
+        }
+
+    private:
+        CompiledNode compileMemberAssignment(MemberExpression &member) {
+            if (m_operator == AssignmentOperator::Assignment) {
+                return [object = member.object()->compile(), right = m_right->compile(), &member](
+                        Interpreter &interpreter) {
+                    const Value target = object(interpreter);
+                    if (interpreter.isUnwinding()) {
+                        return Value();
                     }
-                    case AssignmentOperator::MultiplicationAssignment: {
-                        const Value &value = multiply(m_left->execute(interpreter),
-                                                      m_right->execute(interpreter));
-                        interpreter.setVariable(identifier->name(), value);
-                        break;
+                    TemporaryRoot targetRoot(interpreter, target);
+                    const Value value = right(interpreter);
+                    if (interpreter.isUnwinding()) {
+                        return Value();
                     }
-                    default:
-                        assert(false);
-                        break;
+                    member.putInto(target, value);
+                    return value;
+                };
+            }
+            return [object = member.object()->compile(), right = m_right->compile(), &member, this](
+                    Interpreter &interpreter) {
+                const Value target = object(interpreter);
+                if (interpreter.isUnwinding()) {
+                    return Value();
                 }
+                TemporaryRoot targetRoot(interpreter, target);
+                const Value current = member.getFrom(target);
+                TemporaryRoot currentRoot(interpreter, current);
+                const Value valueRight = right(interpreter);
+                if (interpreter.isUnwinding()) {
+                    return Value();
+                }
+                const Value result = applyOperator(current, valueRight);
+                member.putInto(target, result);
+                return resultOf(current, result);
+            };
+        }
+
+        // The binary operator a compound assignment applies.
+        static Optional<BinaryOperator> compoundOperator(AssignmentOperator op) {
+            switch (op) {
+                case AssignmentOperator::AdditionAssignment:
+                case AssignmentOperator::Increment:
+                    return BinaryOperator::Add;
+                case AssignmentOperator::SubtractionAssignment:
+                case AssignmentOperator::Decrement:
+                    return BinaryOperator::Subtract;
+                case AssignmentOperator::DivisionAssignment:
+                    return BinaryOperator::Divide;
+                case AssignmentOperator::MultiplicationAssignment:
+                    return BinaryOperator::Multiply;
+                default:
+                    return {};
+            }
+        }
+
+        Optional<Bytecode::OpCode> compoundOpcode() const {
+            const auto op = compoundOperator(m_operator);
+            if (!op) {
                 return {};
             }
-            assert(false);
+            return Bytecode::binaryOpCode(*op);
+        }
+
+        Bytecode::Register generateMemberAssignment(Bytecode::Generator &generator, MemberExpression &member) {
+            auto object = member.object()->generateBytecode(generator);
+            if (generator.isVariable(object) && !m_right->isPure()) {
+                const auto copy = generator.allocateRegister();
+                generator.emit(Bytecode::OpCode::Move, copy, object);
+                object = copy;
+            }
+            const auto cache = generator.addPropertyCache(&member.cache());
+            if (m_operator == AssignmentOperator::Assignment) {
+                const auto value = m_right->generateBytecode(generator);
+                generator.emit(Bytecode::OpCode::PutProperty, value, object, cache);
+                return value;
+            }
+            const auto opcode = compoundOpcode();
+            if (!opcode) {
+                generator.unsupported();
+                return 0;
+            }
+            const auto current = generator.allocateRegister();
+            generator.emit(Bytecode::OpCode::GetProperty, current, object, cache);
+            const auto old = generateOldValue(generator, current);
+            const auto right = m_right->generateBytecode(generator);
+            const auto result = generator.allocateRegister();
+            generator.emit(*opcode, result, current, right);
+            generator.emit(Bytecode::OpCode::PutProperty, result, object, cache);
+            return old.value_or(result);
+        }
+
+        // Postfix increments and decrements keep the numeric old value around, it is what they evaluate to.
+        Optional<Bytecode::Register> generateOldValue(Bytecode::Generator &generator, Bytecode::Register current) {
+            if (!m_postfix) {
+                return {};
+            }
+            const auto old = generator.allocateRegister();
+            generator.emit(Bytecode::OpCode::ToNumber, old, current);
+            return old;
+        }
+
+        Value applyOperator(const Value &left, const Value &right) {
+            return m_operation.execute(left, right);
+        }
+
+        // Postfix increments and decrements evaluate to the old value, converted to a number.
+        Value resultOf(const Value &old, const Value &result) const {
+            if (!m_postfix) {
+                return result;
+            }
+            return old.isInt() || old.isNumber() ? old : Value(toNumber(old));
         }
 
-    private:
         AssignmentOperator m_operator;
-        UniquePtr<Expression> m_left;
-        UniquePtr<Expression> m_right;
+        Expression *m_left;
+        Expression *m_right;
+        SpecializingOperator m_operation;
+        bool m_postfix;
     };
 
     class IfStatement : public Statement {
     public:
-        IfStatement(UniquePtr<Expression> test,
-                    UniquePtr<Statement> consequent,
-                    UniquePtr<Statement> alternate)
-                : m_test{std::move(test)},
-                  m_consequent{std::move(consequent)},
-                  m_alternate{std::move(alternate)} {}
-
-        IfStatement(UniquePtr<Expression> test,
-                    UniquePtr<Statement> consequent)
-                : m_test{std::move(test)},
-                  m_consequent{std::move(consequent)} {}
+        IfStatement(Expression *test,
+                    Statement *consequent,
+                    Statement *alternate = nullptr)
+                : m_test{test},
+                  m_consequent{consequent},
+                  m_alternate{alternate} {}
 
         virtual void print(int32_t indent) const override {
             printIndent(indent);
@@ -684,8 +1975,18 @@ namespace LibJS {
             }
         }
 
+        virtual void serialize(ASTWriter &writer) const override {
+            writer.writeKind(NodeKind::IfStatement);
+            writer.writeNode(m_test);
+            writer.writeNode(m_consequent);
+            writer.writeNode(m_alternate);
+        }
+
         virtual Value execute(Interpreter &interpreter) override {
             const auto &value = m_test->execute(interpreter);
+            if (interpreter.isUnwinding()) {
+                return {};
+            }
             if (value.toBoolean()) {
                 return m_consequent->execute(interpreter);
             } else if (m_alternate) {
@@ -694,10 +1995,559 @@ namespace LibJS {
             return {};
         }
 
+        virtual void hoistDeclarations(ScopeAnalyzer &analyzer) override {
+            m_consequent->hoistDeclarations(analyzer);
+            if (m_alternate) {
+                m_alternate->hoistDeclarations(analyzer);
+            }
+        }
+
+        virtual void analyzeScope(ScopeAnalyzer &analyzer) override {
+            m_test->analyzeScope(analyzer);
+            m_consequent->analyzeScope(analyzer);
+            if (m_alternate) {
+                m_alternate->analyzeScope(analyzer);
+            }
+        }
+
+        virtual Statement *foldConstants(ConstantFolder &folder) override {
+            m_test = m_test->foldConstants(folder);
+            m_consequent = foldBranch(folder, m_consequent);
+            if (m_alternate) {
+                m_alternate = foldBranch(folder, m_alternate);
+            }
+
+            const auto *test = dynamic_cast<Literal *>(m_test);
+            if (!test) {
+                return this;
+            }
+            Statement *taken = test->value().toBoolean() ? m_consequent : m_alternate;
+            Statement *dropped = taken == m_consequent ? m_alternate : m_consequent;
+            if (dropped && folder.declaresNames(dropped)) {
+                return this;
+            }
+            return taken;
+        }
+
+        virtual Bytecode::Register generateBytecode(Bytecode::Generator &generator) override {
+            const auto mark = generator.registerMark();
+            const auto test = m_test->generateBytecode(generator);
+            const auto jumpToAlternate = generator.emitJump(Bytecode::OpCode::JumpIfFalse, test);
+            generator.releaseRegisters(mark);
+
+            m_consequent->generateBytecode(generator);
+            generator.releaseRegisters(mark);
+            if (!m_alternate) {
+                generator.patchJump(jumpToAlternate, generator.label());
+                return 0;
+            }
+
+            const auto jumpToEnd = generator.emitJump(Bytecode::OpCode::Jump);
+            generator.patchJump(jumpToAlternate, generator.label());
+            m_alternate->generateBytecode(generator);
+            generator.releaseRegisters(mark);
+            generator.patchJump(jumpToEnd, generator.label());
+            return 0;
+        }
+
+        virtual CompiledNode compile() override {
+            return [test = m_test->compile(), consequent = m_consequent->compile(),
+                    alternate = m_alternate ? m_alternate->compile() : CompiledNode()](Interpreter &interpreter) {
+                const Value value = test(interpreter);
+                if (interpreter.isUnwinding()) {
+                    return Value();
+                }
+                if (value.toBoolean()) {
+                    return consequent(interpreter);
+                } else if (alternate) {
+                    return alternate(interpreter);
+                }
+                return Value();
+            };
+        }
+
+    private:
+        Expression *m_test;
+        Statement *m_consequent;
+        Statement *m_alternate;
+    };
+
+    // Loops consume Break and Continue. Returns whether the loop has to stop, a Return or Throw keeps unwinding.
+    static bool stopsLoop(Interpreter &interpreter) {
+        switch (interpreter.completion()) {
+            case Completion::Normal:
+                return false;
+            case Completion::Continue:
+                interpreter.clearCompletion();
+                return false;
+            case Completion::Break:
+                interpreter.clearCompletion();
+                return true;
+            default:
+                return true;
+        }
+    }
+
+    class WhileStatement : public Statement {
+    public:
+        WhileStatement(Expression *test, Statement *body)
+                : m_test{test},
+                  m_body{body} {}
+
+        virtual void print(int32_t indent) const override {
+            printIndent(indent);
+            std::cout << "[WhileStatement]" << std::endl;
+
+            printIndent(indent + 1);
+            std::cout << "test: " << std::endl;
+            m_test->print(indent + 2);
+
+            printIndent(indent + 1);
+            std::cout << "body: " << std::endl;
+            m_body->print(indent + 2);
+        }
+
+        virtual void serialize(ASTWriter &writer) const override {
+            writer.writeKind(NodeKind::WhileStatement);
+            writer.writeNode(m_test);
+            writer.writeNode(m_body);
+        }
+
+        virtual Value execute(Interpreter &interpreter) override {
+            for (;;) {
+                interpreter.safepoint();
+                const Value test = m_test->execute(interpreter);
+                if (interpreter.isUnwinding() || !test.toBoolean()) {
+                    break;
+                }
+                m_body->execute(interpreter);
+                if (stopsLoop(interpreter)) {
+                    break;
+                }
+            }
+            return {};
+        }
+
+        virtual void hoistDeclarations(ScopeAnalyzer &analyzer) override {
+            m_body->hoistDeclarations(analyzer);
+        }
+
+        virtual void analyzeScope(ScopeAnalyzer &analyzer) override {
+            m_test->analyzeScope(analyzer);
+            m_body->analyzeScope(analyzer);
+        }
+
+        virtual Statement *foldConstants(ConstantFolder &folder) override {
+            m_test = m_test->foldConstants(folder);
+            m_body = foldBranch(folder, m_body);
+            return this;
+        }
+
+        virtual Bytecode::Register generateBytecode(Bytecode::Generator &generator) override {
+            const auto mark = generator.registerMark();
+            const auto loopStart = generator.label();
+            const auto test = m_test->generateBytecode(generator);
+            const auto jumpToEnd = generator.emitJump(Bytecode::OpCode::JumpIfFalse, test);
+            generator.releaseRegisters(mark);
+
+            generator.beginLoop();
+            m_body->generateBytecode(generator);
+            generator.releaseRegisters(mark);
+            generator.patchJump(generator.emitJump(Bytecode::OpCode::Jump), loopStart);
+            generator.patchJump(jumpToEnd, generator.label());
+            generator.endLoop(loopStart, generator.label());
+            return 0;
+        }
+
+        virtual CompiledNode compile() override {
+            return [test = m_test->compile(), body = m_body->compile()](Interpreter &interpreter) {
+                for (;;) {
+                    interpreter.safepoint();
+                    const Value value = test(interpreter);
+                    if (interpreter.isUnwinding() || !value.toBoolean()) {
+                        break;
+                    }
+                    body(interpreter);
+                    if (stopsLoop(interpreter)) {
+                        break;
+                    }
+                }
+                return Value();
+            };
+        }
+
+    private:
+        Expression *m_test;
+        Statement *m_body;
+    };
+
+    class ForStatement : public Statement {
+    public:
+        // Every part but the body is optional.
+        ForStatement(Statement *init, Expression *test, Expression *update, Statement *body)
+                : m_init{init},
+                  m_test{test},
+                  m_update{update},
+                  m_body{body} {}
+
+        virtual void print(int32_t indent) const override {
+            printIndent(indent);
+            std::cout << "[ForStatement]" << std::endl;
+
+            if (m_init) {
+                printIndent(indent + 1);
+                std::cout << "init: " << std::endl;
+                m_init->print(indent + 2);
+            }
+            if (m_test) {
+                printIndent(indent + 1);
+                std::cout << "test: " << std::endl;
+                m_test->print(indent + 2);
+            }
+            if (m_update) {
+                printIndent(indent + 1);
+                std::cout << "update: " << std::endl;
+                m_update->print(indent + 2);
+            }
+
+            printIndent(indent + 1);
+            std::cout << "body: " << std::endl;
+            m_body->print(indent + 2);
+        }
+
+        virtual void serialize(ASTWriter &writer) const override {
+            writer.writeKind(NodeKind::ForStatement);
+            writer.writeNode(m_init);
+            writer.writeNode(m_test);
+            writer.writeNode(m_update);
+            writer.writeNode(m_body);
+        }
+
+        virtual Value execute(Interpreter &interpreter) override {
+            if (m_init) {
+                m_init->execute(interpreter);
+                if (interpreter.isUnwinding()) {
+                    return {};
+                }
+            }
+            for (;;) {
+                interpreter.safepoint();
+                if (m_test) {
+                    const Value test = m_test->execute(interpreter);
+                    if (interpreter.isUnwinding() || !test.toBoolean()) {
+                        break;
+                    }
+                }
+                m_body->execute(interpreter);
+                if (stopsLoop(interpreter)) {
+                    break;
+                }
+                if (m_update) {
+                    m_update->execute(interpreter);
+                    if (interpreter.isUnwinding()) {
+                        break;
+                    }
+                }
+            }
+            return {};
+        }
+
+        virtual void hoistDeclarations(ScopeAnalyzer &analyzer) override {
+            if (m_init) {
+                m_init->hoistDeclarations(analyzer);
+            }
+            m_body->hoistDeclarations(analyzer);
+        }
+
+        virtual void analyzeScope(ScopeAnalyzer &analyzer) override {
+            if (m_init) {
+                m_init->analyzeScope(analyzer);
+            }
+            if (m_test) {
+                m_test->analyzeScope(analyzer);
+            }
+            if (m_update) {
+                m_update->analyzeScope(analyzer);
+            }
+            m_body->analyzeScope(analyzer);
+        }
+
+        virtual Statement *foldConstants(ConstantFolder &folder) override {
+            if (m_init) {
+                m_init = m_init->foldConstants(folder);
+            }
+            if (m_test) {
+                m_test = m_test->foldConstants(folder);
+            }
+            if (m_update) {
+                m_update = m_update->foldConstants(folder);
+            }
+            m_body = foldBranch(folder, m_body);
+            return this;
+        }
+
+        virtual Bytecode::Register generateBytecode(Bytecode::Generator &generator) override {
+            const auto mark = generator.registerMark();
+            if (m_init) {
+                m_init->generateBytecode(generator);
+                generator.releaseRegisters(mark);
+            }
+            const auto loopStart = generator.label();
+            Optional<size_t> jumpToEnd;
+            if (m_test) {
+                const auto test = m_test->generateBytecode(generator);
+                jumpToEnd = generator.emitJump(Bytecode::OpCode::JumpIfFalse, test);
+                generator.releaseRegisters(mark);
+            }
+
+            generator.beginLoop();
+            m_body->generateBytecode(generator);
+            generator.releaseRegisters(mark);
+            const auto continueTarget = generator.label();
+            if (m_update) {
+                m_update->generateBytecode(generator);
+                generator.releaseRegisters(mark);
+            }
+            generator.patchJump(generator.emitJump(Bytecode::OpCode::Jump), loopStart);
+            if (jumpToEnd) {
+                generator.patchJump(*jumpToEnd, generator.label());
+            }
+            generator.endLoop(continueTarget, generator.label());
+            return 0;
+        }
+
+        virtual CompiledNode compile() override {
+            return [init = m_init ? m_init->compile() : CompiledNode(), test = m_test ? m_test->compile() : CompiledNode(),
+                    update = m_update ? m_update->compile() : CompiledNode(), body = m_body->compile()](
+                    Interpreter &interpreter) {
+                if (init) {
+                    init(interpreter);
+                    if (interpreter.isUnwinding()) {
+                        return Value();
+                    }
+                }
+                for (;;) {
+                    interpreter.safepoint();
+                    if (test) {
+                        const Value value = test(interpreter);
+                        if (interpreter.isUnwinding() || !value.toBoolean()) {
+                            break;
+                        }
+                    }
+                    body(interpreter);
+                    if (stopsLoop(interpreter)) {
+                        break;
+                    }
+                    if (update) {
+                        update(interpreter);
+                        if (interpreter.isUnwinding()) {
+                            break;
+                        }
+                    }
+                }
+                return Value();
+            };
+        }
+
+    private:
+        Statement *m_init;
+        Expression *m_test;
+        Expression *m_update;
+        Statement *m_body;
+    };
+
+    class BreakStatement : public Statement {
+    public:
+        virtual void print(int32_t indent) const override {
+            printIndent(indent);
+            std::cout << "[BreakStatement]" << std::endl;
+        }
+
+        virtual void serialize(ASTWriter &writer) const override {
+            writer.writeKind(NodeKind::BreakStatement);
+        }
+
+        virtual Value execute(Interpreter &interpreter) override {
+            interpreter.breakLoop();
+            return {};
+        }
+
+        virtual Bytecode::Register generateBytecode(Bytecode::Generator &generator) override {
+            generator.emitBreak();
+            return 0;
+        }
+    };
+
+    class ContinueStatement : public Statement {
+    public:
+        virtual void print(int32_t indent) const override {
+            printIndent(indent);
+            std::cout << "[ContinueStatement]" << std::endl;
+        }
+
+        virtual void serialize(ASTWriter &writer) const override {
+            writer.writeKind(NodeKind::ContinueStatement);
+        }
+
+        virtual Value execute(Interpreter &interpreter) override {
+            interpreter.continueLoop();
+            return {};
+        }
+
+        virtual Bytecode::Register generateBytecode(Bytecode::Generator &generator) override {
+            generator.emitContinue();
+            return 0;
+        }
+    };
+
+    // The bytecode has no exception handling, functions that throw or catch stay in the AST interpreter.
+    class ThrowStatement : public Statement {
+    public:
+        ThrowStatement(Expression *argument)
+                : m_argument{argument} {}
+
+        virtual void print(int32_t indent) const override {
+            printIndent(indent);
+            std::cout << "[ThrowStatement]" << std::endl;
+            printIndent(indent + 1);
+            std::cout << "argument: " << std::endl;
+            m_argument->print(indent + 2);
+        }
+
+        virtual void serialize(ASTWriter &writer) const override {
+            writer.writeKind(NodeKind::ThrowStatement);
+            writer.writeNode(m_argument);
+        }
+
+        virtual Value execute(Interpreter &interpreter) override {
+            const Value value = m_argument->execute(interpreter);
+            if (!interpreter.isUnwinding()) {
+                interpreter.throwException(value);
+            }
+            return {};
+        }
+
+        virtual void analyzeScope(ScopeAnalyzer &analyzer) override {
+            m_argument->analyzeScope(analyzer);
+        }
+
+        virtual Statement *foldConstants(ConstantFolder &folder) override {
+            m_argument = m_argument->foldConstants(folder);
+            return this;
+        }
+
+    private:
+        Expression *m_argument;
+    };
+
+    class TryStatement : public Statement {
+    public:
+        // Either the handler or the finalizer may be missing, the catch parameter is optional as well.
+        TryStatement(BlockStatement *block, Identifier *parameter, BlockStatement *handler, BlockStatement *finalizer)
+                : m_block{block},
+                  m_parameter{parameter},
+                  m_handler{handler},
+                  m_finalizer{finalizer} {}
+
+        virtual void print(int32_t indent) const override {
+            printIndent(indent);
+            std::cout << "[TryStatement]" << std::endl;
+
+            printIndent(indent + 1);
+            std::cout << "block: " << std::endl;
+            m_block->print(indent + 2);
+
+            if (m_parameter) {
+                printIndent(indent + 1);
+                std::cout << "param: " << std::endl;
+                m_parameter->print(indent + 2);
+            }
+            if (m_handler) {
+                printIndent(indent + 1);
+                std::cout << "handler: " << std::endl;
+                m_handler->print(indent + 2);
+            }
+            if (m_finalizer) {
+                printIndent(indent + 1);
+                std::cout << "finalizer: " << std::endl;
+                m_finalizer->print(indent + 2);
+            }
+        }
+
+        virtual void serialize(ASTWriter &writer) const override {
+            writer.writeKind(NodeKind::TryStatement);
+            writer.writeNode(m_block);
+            writer.writeNode(m_parameter);
+            writer.writeNode(m_handler);
+            writer.writeNode(m_finalizer);
+        }
+
+        virtual Value execute(Interpreter &interpreter) override {
+            m_block->execute(interpreter);
+            if (m_handler && interpreter.completion() == Completion::Throw) {
+                const Value exception = interpreter.clearCompletion();
+                if (m_parameter) {
+                    interpreter.setVariable(m_parameter->location(), exception);
+                }
+                m_handler->execute(interpreter);
+            }
+            if (m_finalizer) {
+                // The pending completion is set aside while the finalizer runs, and only resumes if the finalizer
+                // itself completes normally.
+                const Completion completion = interpreter.completion();
+                const Value value = interpreter.clearCompletion();
+                TemporaryRoot valueRoot(interpreter, value);
+                m_finalizer->execute(interpreter);
+                if (!interpreter.isUnwinding()) {
+                    interpreter.complete(completion, value);
+                }
+            }
+            return {};
+        }
+
+        // Vars in the blocks are hoisted to the enclosing function, the catch parameter is declared in a block scope of
+        // the handler, see analyzeScope.
+        virtual void hoistDeclarations(ScopeAnalyzer &analyzer) override {
+            m_block->hoistDeclarations(analyzer);
+            if (m_handler) {
+                m_handler->hoistDeclarations(analyzer);
+            }
+            if (m_finalizer) {
+                m_finalizer->hoistDeclarations(analyzer);
+            }
+        }
+
+        virtual void analyzeScope(ScopeAnalyzer &analyzer) override {
+            m_block->analyzeScope(analyzer);
+            if (m_handler) {
+                analyzer.enterBlockScope();
+                if (m_parameter) {
+                    m_parameter->declare(analyzer);
+                }
+                m_handler->analyzeScope(analyzer);
+                analyzer.leaveScope();
+            }
+            if (m_finalizer) {
+                m_finalizer->analyzeScope(analyzer);
+            }
+        }
+
+        virtual Statement *foldConstants(ConstantFolder &folder) override {
+            m_block->foldConstants(folder);
+            if (m_handler) {
+                m_handler->foldConstants(folder);
+            }
+            if (m_finalizer) {
+                m_finalizer->foldConstants(folder);
+            }
+            return this;
+        }
+
     private:
-        UniquePtr<Expression> m_test;
-        UniquePtr<Statement> m_consequent;
-        UniquePtr<Statement> m_alternate;
+        BlockStatement *m_block;
+        Identifier *m_parameter;
+        BlockStatement *m_handler;
+        BlockStatement *m_finalizer;
     };
 
 }
@@ -0,0 +1,145 @@
+//
+// Bump pointer allocator. Everything allocated from an Arena is released at once by reset() or its destructor.
+//
+
+#pragma once
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <string_view>
+#include <type_traits>
+#include "Types.h"
+
+namespace LibJS {
+
+    class Arena final {
+    public:
+        explicit Arena(size_t chunkSize = 64 * 1024)
+                : m_chunkSize{chunkSize} {}
+
+        Arena(const Arena &) = delete;
+
+        Arena &operator=(const Arena &) = delete;
+
+        ~Arena() {
+            reset();
+            releaseChunks(m_chunks);
+        }
+
+        void *allocate(size_t size, size_t alignment) {
+            const uintptr_t aligned = (m_current + alignment - 1) & ~(alignment - 1);
+            if (aligned + size > m_end || m_current == 0) {
+                return allocateSlow(size, alignment);
+            }
+            m_current = aligned + size;
+            return reinterpret_cast<void *>(aligned);
+        }
+
+        // Only objects that need it get their destructor recorded, trivially destructible ones cost a bump.
+        template<typename T, typename... Args>
+        T *make(Args &&... args) {
+            T *object = new(allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+            if constexpr (!std::is_trivially_destructible_v<T>) {
+                auto *destructor = new(allocate(sizeof(Destructor), alignof(Destructor))) Destructor{
+                        [](void *pointer) { static_cast<T *>(pointer)->~T(); }, object, m_destructors};
+                m_destructors = destructor;
+            }
+            return object;
+        }
+
+        std::string_view copyString(std::string_view string) {
+            if (string.empty()) {
+                return {};
+            }
+            auto *characters = static_cast<char *>(allocate(string.size(), 1));
+            std::memcpy(characters, string.data(), string.size());
+            return {characters, string.size()};
+        }
+
+        template<typename T>
+        Span<T> copyArray(Span<const T> elements) {
+            static_assert(std::is_trivially_copyable_v<T> && std::is_trivially_destructible_v<T>);
+            if (elements.empty()) {
+                return {};
+            }
+            auto *copy = static_cast<T *>(allocate(sizeof(T) * elements.size(), alignof(T)));
+            std::memcpy(copy, elements.data(), sizeof(T) * elements.size());
+            return {copy, elements.size()};
+        }
+
+        // Runs the recorded destructors in reverse order of construction and keeps one chunk for reuse.
+        void reset() {
+            for (Destructor *destructor = m_destructors; destructor; destructor = destructor->next) {
+                destructor->destroy(destructor->object);
+            }
+            m_destructors = nullptr;
+            if (!m_chunks) {
+                return;
+            }
+            releaseChunks(m_chunks->next);
+            m_chunks->next = nullptr;
+            m_current = reinterpret_cast<uintptr_t>(m_chunks + 1);
+            m_end = reinterpret_cast<uintptr_t>(m_chunks) + m_chunks->size;
+            m_bytesAllocated = m_chunks->size;
+        }
+
+        // Bytes reserved from the system, including the unused tail of the current chunk.
+        size_t bytesAllocated() const { return m_bytesAllocated; }
+
+    private:
+        struct alignas(std::max_align_t) Chunk {
+            Chunk *next;
+            size_t size;
+        };
+
+        struct Destructor {
+            void (*destroy)(void *);
+            void *object;
+            Destructor *next;
+        };
+
+        void *allocateSlow(size_t size, size_t alignment) {
+            // Large allocations get a chunk of their own so they don't waste the rest of the current one.
+            const size_t chunkSize = std::max(m_chunkSize, sizeof(Chunk) + size + alignment);
+            auto *chunk = static_cast<Chunk *>(std::malloc(chunkSize));
+            if (!chunk) {
+                throw std::bad_alloc();
+            }
+            m_bytesAllocated += chunkSize;
+
+            if (chunkSize > m_chunkSize && m_chunks) {
+                // Keep bumping in the current chunk, the dedicated one is only linked for release.
+                chunk->size = chunkSize;
+                chunk->next = m_chunks->next;
+                m_chunks->next = chunk;
+                const uintptr_t start = reinterpret_cast<uintptr_t>(chunk + 1);
+                return reinterpret_cast<void *>((start + alignment - 1) & ~(alignment - 1));
+            }
+
+            chunk->size = chunkSize;
+            chunk->next = m_chunks;
+            m_chunks = chunk;
+            m_current = reinterpret_cast<uintptr_t>(chunk + 1);
+            m_end = reinterpret_cast<uintptr_t>(chunk) + chunkSize;
+            return allocate(size, alignment);
+        }
+
+        static void releaseChunks(Chunk *chunk) {
+            while (chunk) {
+                Chunk *next = chunk->next;
+                std::free(chunk);
+                chunk = next;
+            }
+        }
+
+        size_t m_chunkSize;
+        Chunk *m_chunks{nullptr};
+        uintptr_t m_current{0};
+        uintptr_t m_end{0};
+        Destructor *m_destructors{nullptr};
+        size_t m_bytesAllocated{0};
+    };
+
+}
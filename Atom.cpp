@@ -0,0 +1,80 @@
+//
+// Interned strings for identifiers and property keys.
+//
+
+#include "Atom.h"
+#include "Arena.h"
+
+namespace LibJS {
+
+    // Open addressing with linear probing, the hash is compared before the characters.
+    class AtomTable final {
+    public:
+        static AtomTable &the() {
+            static AtomTable s_table;
+            return s_table;
+        }
+
+        Atom intern(std::string_view string) {
+            if (string.empty()) {
+                return {};
+            }
+            const size_t hash = std::hash<std::string_view>()(string);
+            size_t index = hash & (m_buckets.size() - 1);
+            while (const Atom::Data *data = m_buckets[index]) {
+                if (data->hash == hash && std::string_view(data->characters(), data->length) == string) {
+                    return Atom(data);
+                }
+                index = (index + 1) & (m_buckets.size() - 1);
+            }
+
+            auto *data = static_cast<Atom::Data *>(m_arena.allocate(sizeof(Atom::Data) + string.size(),
+                                                                    alignof(Atom::Data)));
+            data->hash = hash;
+            data->length = string.size();
+            std::memcpy(const_cast<char *>(data->characters()), string.data(), string.size());
+            m_buckets[index] = data;
+            if (++m_count * 2 > m_buckets.size()) {
+                grow();
+            }
+            return Atom(data);
+        }
+
+        size_t bytesAllocated() const {
+            return m_arena.bytesAllocated() + m_buckets.capacity() * sizeof(const Atom::Data *);
+        }
+
+    private:
+        static constexpr size_t InitialCapacity = 1024;
+
+        AtomTable() : m_buckets(InitialCapacity, nullptr) {}
+
+        void grow() {
+            Vector<const Atom::Data *> buckets(m_buckets.size() * 2, nullptr);
+            for (const Atom::Data *data : m_buckets) {
+                if (!data) {
+                    continue;
+                }
+                size_t index = data->hash & (buckets.size() - 1);
+                while (buckets[index]) {
+                    index = (index + 1) & (buckets.size() - 1);
+                }
+                buckets[index] = data;
+            }
+            m_buckets = std::move(buckets);
+        }
+
+        Arena m_arena;
+        Vector<const Atom::Data *> m_buckets;
+        size_t m_count{0};
+    };
+
+}
+
+LibJS::Atom LibJS::Atom::intern(std::string_view string) {
+    return AtomTable::the().intern(string);
+}
+
+size_t LibJS::Atom::bytesAllocated() {
+    return AtomTable::the().bytesAllocated();
+}
@@ -0,0 +1,68 @@
+//
+// Interned strings for identifiers and property keys. Every distinct string is stored once, so atoms compare by
+// pointer and carry their hash with them.
+//
+
+#pragma once
+
+#include <functional>
+#include <ostream>
+#include <string_view>
+#include "Types.h"
+
+namespace LibJS {
+
+    class Atom final {
+    public:
+        // The empty string.
+        Atom() = default;
+
+        // Atoms are never freed, interning is meant for names from source code, not for runtime generated strings.
+        // The table is process wide instead of owned by an interpreter: parsers and the code cache intern without one,
+        // and a program has to find the same atoms in whichever interpreter runs it. Like the rest of the runtime the
+        // table isn't thread safe.
+        static Atom intern(std::string_view string);
+
+        // Bytes reserved by the table for the atoms and its buckets.
+        static size_t bytesAllocated();
+
+        std::string_view string() const {
+            return m_data ? std::string_view(m_data->characters(), m_data->length) : std::string_view();
+        }
+
+        size_t hash() const { return m_data ? m_data->hash : 0; }
+
+        bool isEmpty() const { return !m_data; }
+
+        bool operator==(const Atom &other) const { return m_data == other.m_data; }
+
+        bool operator!=(const Atom &other) const { return m_data != other.m_data; }
+
+    private:
+        friend class AtomTable;
+
+        // The characters follow right behind the header.
+        struct Data {
+            size_t hash;
+            size_t length;
+
+            const char *characters() const { return reinterpret_cast<const char *>(this + 1); }
+        };
+
+        explicit Atom(const Data *data) : m_data{data} {}
+
+        const Data *m_data{nullptr};
+    };
+
+    static_assert(sizeof(Atom) == sizeof(void *));
+
+    inline std::ostream &operator<<(std::ostream &stream, const Atom &atom) {
+        return stream << atom.string();
+    }
+
+}
+
+template<>
+struct std::hash<LibJS::Atom> {
+    size_t operator()(const LibJS::Atom &atom) const { return atom.hash(); }
+};
@@ -0,0 +1,65 @@
+//
+// Result collection and output of the LibJSBench benchmarks.
+//
+
+#include <iomanip>
+#include "Benchmark.h"
+
+namespace {
+
+    struct Result {
+        LibJS::String name;
+        LibJS::String unit;
+        LibJS::Benchmark::Samples samples;
+    };
+
+    LibJS::Vector<Result> &results() {
+        static LibJS::Vector<Result> s_results;
+        return s_results;
+    }
+
+    void printJsonString(std::ostream &stream, const LibJS::String &string) {
+        stream << '"';
+        for (const char character : string) {
+            if (character == '"' || character == '\\') {
+                stream << '\\';
+            }
+            stream << character;
+        }
+        stream << '"';
+    }
+
+}
+
+void LibJS::Benchmark::report(String name, const Samples &samples, String unit) {
+    results().push_back({std::move(name), std::move(unit), samples});
+}
+
+void LibJS::Benchmark::report(String name, double value, String unit) {
+    report(std::move(name), Samples{value, value, value}, std::move(unit));
+}
+
+void LibJS::Benchmark::printText(std::ostream &stream) {
+    for (const auto &result : results()) {
+        stream << result.name << ": " << result.samples.median << ' ' << result.unit;
+        if (result.samples.min != result.samples.max) {
+            stream << " (" << result.samples.min << " .. " << result.samples.max << ')';
+        }
+        stream << std::endl;
+    }
+}
+
+void LibJS::Benchmark::printJson(std::ostream &stream) {
+    stream << std::setprecision(6) << "{\n  \"benchmarks\": [";
+    bool first = true;
+    for (const auto &result : results()) {
+        stream << (first ? "\n" : ",\n") << "    {\"name\": ";
+        printJsonString(stream, result.name);
+        stream << ", \"unit\": ";
+        printJsonString(stream, result.unit);
+        stream << ", \"median\": " << result.samples.median << ", \"min\": " << result.samples.min
+               << ", \"max\": " << result.samples.max << '}';
+        first = false;
+    }
+    stream << "\n  ]\n}" << std::endl;
+}
@@ -0,0 +1,79 @@
+//
+// Minimal timing and reporting helpers shared by the LibJSBench benchmarks.
+//
+
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <limits>
+#include <iostream>
+#include "Types.h"
+
+namespace LibJS::Benchmark {
+
+    // Keeps the compiler from optimizing away results that are never read.
+    inline volatile uint64_t g_sink = 0;
+
+    template<typename Callback>
+    double measureNanosecondsPerIteration(int32_t iterations, Callback callback) {
+        const auto start = std::chrono::steady_clock::now();
+        for (int32_t i = 0; i < iterations; ++i) {
+            callback();
+        }
+        const auto end = std::chrono::steady_clock::now();
+        return std::chrono::duration<double, std::nano>(end - start).count() / iterations;
+    }
+
+    // Best of `runs` single executions, less sensitive to noise than the mean for long running callbacks.
+    template<typename Callback>
+    double measureBestNanoseconds(int32_t runs, Callback callback) {
+        double best = std::numeric_limits<double>::max();
+        for (int32_t i = 0; i < runs; ++i) {
+            best = std::min(best, measureNanosecondsPerIteration(1, callback));
+        }
+        return best;
+    }
+
+    // Nanoseconds per iteration over repeated samples. Results are compared by their median, min and max show how
+    // noisy the machine was while measuring.
+    struct Samples {
+        double median;
+        double min;
+        double max;
+    };
+
+    // `samples` timed batches of `iterations` calls each, after one untimed batch that warms up caches, inline caches
+    // and lazily compiled code.
+    template<typename Callback>
+    Samples measureSamples(int32_t samples, int32_t iterations, Callback callback) {
+        assert(samples > 0);
+        measureNanosecondsPerIteration(iterations, callback);
+        Vector<double> timings;
+        for (int32_t i = 0; i < samples; ++i) {
+            timings.push_back(measureNanosecondsPerIteration(iterations, callback));
+        }
+        std::sort(timings.begin(), timings.end());
+        return {timings[timings.size() / 2], timings.front(), timings.back()};
+    }
+
+    // Results are collected while the benchmarks run and printed once all of them are done. Names are paths like
+    // "operator/add/int32-double", so related results sort next to each other.
+    void report(String name, const Samples &samples, String unit = "ns");
+
+    // For results that are measured once, like sizes or throughputs.
+    void report(String name, double value, String unit);
+
+    void printText(std::ostream &stream);
+
+    void printJson(std::ostream &stream);
+
+    void runValueBenchmarks();
+
+    void runOperatorBenchmarks();
+
+    void runInterpreterBenchmarks();
+
+    void runParserBenchmarks();
+
+}
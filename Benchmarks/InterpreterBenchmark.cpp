@@ -0,0 +1,113 @@
+//
+// Microbenchmarks for variable access and call overhead in every execution mode.
+//
+
+#include "Benchmark.h"
+#include "Parser.h"
+
+namespace {
+
+    constexpr int32_t Samples = 7;
+
+    void benchmarkGetVariable(LibJS::Interpreter &interpreter, const LibJS::String &name,
+                              const LibJS::VariableLocation &location) {
+        constexpr int32_t iterations = 1'000'000;
+        LibJS::Value value;
+        const auto samples = LibJS::Benchmark::measureSamples(Samples, iterations, [&] {
+            value = interpreter.getVariable(location);
+        });
+        LibJS::Benchmark::g_sink = value.encoded();
+        LibJS::Benchmark::report("interpreter/getVariable/" + name, samples);
+    }
+
+    // Function frames with one captured variable each, so every frame adds an environment to the chain.
+    void benchmarkVariableDepths() {
+        using Kind = LibJS::VariableLocation::Kind;
+        constexpr int32_t depths[] = {0, 1, 2, 4, 8, 16};
+        constexpr int32_t frameCount = depths[std::size(depths) - 1] + 1;
+
+        LibJS::Interpreter interpreter;
+        LibJS::FrameLayout globalLayout;
+        globalLayout.addSlot(LibJS::Atom::intern("global"));
+        interpreter.enterProgram(globalLayout);
+        // Frames point into the vector, it must not grow once they are pushed.
+        LibJS::Vector<LibJS::FrameLayout> layouts(frameCount);
+        for (auto &layout : layouts) {
+            layout.addSlot(LibJS::Atom::intern("local"));
+            layout.addEnvironmentSlot();
+            interpreter.pushStackFrame(layout, interpreter.currentStackFrame().environment());
+        }
+
+        benchmarkGetVariable(interpreter, "local", {Kind::Local, 0, 0});
+        benchmarkGetVariable(interpreter, "global", {Kind::Global, 0, 0});
+        for (const auto hops : depths) {
+            const LibJS::VariableLocation location{Kind::Environment, hops, 0};
+            interpreter.setVariable(location, LibJS::Value(hops));
+            benchmarkGetVariable(interpreter, "environment-" + std::to_string(hops), location);
+        }
+
+        for (int32_t i = 0; i < frameCount; ++i) {
+            interpreter.popStackFrame();
+        }
+    }
+
+    struct Mode {
+        const char *name;
+        LibJS::Interpreter::ExecutionMode mode;
+        bool jit;
+    };
+
+    // Nanoseconds per loop iteration of the program, the program is parsed once and run once per sample.
+    LibJS::Benchmark::Samples measureScript(const Mode &mode, const LibJS::String &source, int32_t iterations) {
+        LibJS::Parser parser(source);
+        const auto program = parser.parseProgram();
+        assert(!parser.hasError());
+        LibJS::Interpreter interpreter(mode.mode);
+        interpreter.setJitEnabled(mode.jit);
+        auto samples = LibJS::Benchmark::measureSamples(Samples, 1, [&] {
+            program->execute(interpreter);
+            assert(!interpreter.isUnwinding());
+        });
+        samples.median /= iterations;
+        samples.min /= iterations;
+        samples.max /= iterations;
+        return samples;
+    }
+
+    // The cost of a call is what a loop calling an empty function takes on top of the same loop without the call. The
+    // loops run at the top level, in the jit mode only the called function is compiled.
+    void benchmarkCalls() {
+        constexpr int32_t iterations = 100'000;
+        const LibJS::String loop = "var i = 0;\n"
+                                   "while (i < 100000) {\n"
+                                   "    i = i + 1;\n"
+                                   "}\n";
+        const LibJS::String calls = "function f(a) {\n"
+                                    "    return a;\n"
+                                    "}\n"
+                                    "var i = 0;\n"
+                                    "while (i < 100000) {\n"
+                                    "    f(i);\n"
+                                    "    i = i + 1;\n"
+                                    "}\n";
+        const Mode modes[] = {
+                {"ast", LibJS::Interpreter::ExecutionMode::AST, false},
+                {"closure", LibJS::Interpreter::ExecutionMode::Closure, false},
+                {"bytecode", LibJS::Interpreter::ExecutionMode::Bytecode, false},
+                {"jit", LibJS::Interpreter::ExecutionMode::Bytecode, true},
+        };
+        for (const auto &mode : modes) {
+            const auto loopSamples = measureScript(mode, loop, iterations);
+            const auto callSamples = measureScript(mode, calls, iterations);
+            LibJS::Benchmark::report(LibJS::String("interpreter/loop/") + mode.name, loopSamples);
+            LibJS::Benchmark::report(LibJS::String("interpreter/call/") + mode.name,
+                                     callSamples.median - loopSamples.median, "ns");
+        }
+    }
+
+}
+
+void LibJS::Benchmark::runInterpreterBenchmarks() {
+    benchmarkVariableDepths();
+    benchmarkCalls();
+}
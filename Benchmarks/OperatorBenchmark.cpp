@@ -0,0 +1,57 @@
+//
+// Microbenchmarks for the binary operators on every combination of operand types.
+//
+
+#include "Benchmark.h"
+#include "Interpreter.h"
+
+namespace {
+
+    struct Operand {
+        const char *type;
+        LibJS::Value value;
+    };
+
+    using Operator = LibJS::Value (*)(const LibJS::Value &left, const LibJS::Value &right);
+
+    void benchmarkOperator(const char *name, Operator op, const LibJS::Vector<Operand> &operands) {
+        constexpr int32_t samples = 5;
+        constexpr int32_t iterations = 20'000;
+        for (const auto &left : operands) {
+            for (const auto &right : operands) {
+                // String results allocate, every combination gets its own heap so they don't pile up.
+                LibJS::Heap heap;
+                LibJS::Value result;
+                const auto timing = LibJS::Benchmark::measureSamples(samples, iterations, [&] {
+                    result = op(left.value, right.value);
+                });
+                LibJS::Benchmark::g_sink = result.encoded();
+                LibJS::Benchmark::report(LibJS::String("operator/") + name + "/" + left.type + "-" + right.type,
+                                         timing);
+            }
+        }
+    }
+
+}
+
+void LibJS::Benchmark::runOperatorBenchmarks() {
+    // Owns the operands' cells and gives the object operand its shape.
+    Interpreter interpreter;
+    const BigInt bigInt("12345678901234567890");
+    const Vector<Operand> operands{
+            {"undefined", Value()},
+            {"null", Value::null()},
+            {"boolean", Value(true)},
+            {"int32", Value(42)},
+            {"double", Value(4.2)},
+            {"string", Value(String("17"))},
+            {"bigint", Value(&bigInt)},
+            {"object", Value(interpreter.createObject())},
+    };
+
+    benchmarkOperator("add", &add, operands);
+    benchmarkOperator("subtract", &subtract, operands);
+    benchmarkOperator("multiply", &multiply, operands);
+    benchmarkOperator("divide", &divide, operands);
+    benchmarkOperator("greaterThan", &greaterThan, operands);
+}
@@ -0,0 +1,86 @@
+//
+// Lexer and parser throughput on a generated multi-megabyte script.
+//
+
+#include "Benchmark.h"
+#include "Parser.h"
+#include "CodeCache.h"
+
+namespace {
+
+    LibJS::String generateSource(size_t minimumSize) {
+        LibJS::String source;
+        source.reserve(minimumSize + 512);
+        for (int32_t i = 1; source.size() < minimumSize; ++i) {
+            const auto n = std::to_string(i);
+            source += "// Function number " + n + "\n"
+                      "function compute" + n + "(left, right) {\n"
+                      "    /* Mixes arithmetic, strings and calls like bundled code does. */\n"
+                      "    var result" + n + " = left * " + n + " + right / 2.5 - 0x1f;\n"
+                      "    if (result" + n + " > 100) {\n"
+                      "        result" + n + " += \"string literal number " + n + "\";\n"
+                      "    } else {\n"
+                      "        result" + n + " = compute" + std::to_string(i > 1 ? i - 1 : 1) + "(left, right);\n"
+                      "    }\n"
+                      "    return result" + n + ";\n"
+                      "}\n\n";
+        }
+        return source;
+    }
+
+    double megabytesPerSecond(size_t bytes, double nanoseconds) {
+        return (static_cast<double>(bytes) / (1024.0 * 1024.0)) / (nanoseconds / 1e9);
+    }
+
+}
+
+void LibJS::Benchmark::runParserBenchmarks() {
+    const String source = generateSource(8 * 1024 * 1024);
+    constexpr int32_t runs = 10;
+
+    size_t tokenCount = 0;
+    const double lexNanoseconds = measureBestNanoseconds(runs, [&] {
+        Lexer lexer(source);
+        tokenCount = 0;
+        while (lexer.next().type != TokenType::Eof) {
+            ++tokenCount;
+        }
+    });
+    g_sink = tokenCount;
+    report("parser/lex", megabytesPerSecond(source.size(), lexNanoseconds), "MB/s");
+
+    // Parsing and tearing the AST down are timed separately, teardown is now a single arena reset.
+    double parseNanoseconds = std::numeric_limits<double>::max();
+    double teardownNanoseconds = std::numeric_limits<double>::max();
+    size_t arenaBytes = 0;
+    for (int32_t run = 0; run < runs; ++run) {
+        UniquePtr<Program> program;
+        parseNanoseconds = std::min(parseNanoseconds, measureNanosecondsPerIteration(1, [&] {
+            Parser parser(source);
+            program = parser.parseProgram();
+            assert(!parser.hasError());
+        }));
+        arenaBytes = program->arena().bytesAllocated();
+        teardownNanoseconds = std::min(teardownNanoseconds, measureNanosecondsPerIteration(1, [&] {
+            program.reset();
+        }));
+    }
+    report("parser/parse", megabytesPerSecond(source.size(), parseNanoseconds), "MB/s");
+    report("parser/arena", static_cast<double>(arenaBytes) / 1024, "KiB");
+    report("parser/teardown", teardownNanoseconds / 1e6, "ms");
+
+    // What a code cache hit costs instead of the parse, the same source rate so the two compare directly. Decoding from
+    // memory leaves out the file's mmap, which is independent of its size.
+    const auto cached = CodeCache::serialize(*Parser(source).parseProgram(), source);
+    assert(cached);
+    const double loadNanoseconds = measureBestNanoseconds(runs, [&] {
+        auto program = CodeCache::deserialize(*cached, source);
+        assert(program);
+        g_sink = program->arena().bytesAllocated();
+    });
+    report("parser/load-cache", megabytesPerSecond(source.size(), loadNanoseconds), "MB/s");
+    report("parser/cache-size", static_cast<double>(cached->size()) / 1024, "KiB");
+
+    // Every name of the generated script stays interned after its programs are gone.
+    report("parser/atoms", static_cast<double>(Atom::bytesAllocated()) / 1024, "KiB");
+}
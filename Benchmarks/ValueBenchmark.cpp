@@ -0,0 +1,73 @@
+//
+// Microbenchmarks for the size, construction and copy cost of LibJS::Value.
+//
+
+#include "Benchmark.h"
+#include "Value.h"
+
+namespace {
+
+    constexpr int32_t Samples = 7;
+
+    template<typename Factory>
+    void benchmarkConstruction(const char *name, int32_t iterations, Factory factory) {
+        LibJS::Vector<LibJS::Value> values(16);
+        int32_t index = 0;
+        const auto samples = LibJS::Benchmark::measureSamples(Samples, iterations, [&] {
+            values[index++ & 15] = factory();
+        });
+        LibJS::Benchmark::g_sink = values[0].encoded();
+        LibJS::Benchmark::report(LibJS::String("value/construct/") + name, samples);
+    }
+
+    void benchmarkCopy(const char *name, const LibJS::Value &value) {
+        constexpr int32_t iterations = 1'000'000;
+        LibJS::Vector<LibJS::Value> copies(16);
+        int32_t index = 0;
+        const auto samples = LibJS::Benchmark::measureSamples(Samples, iterations, [&] {
+            copies[index++ & 15] = value;
+        });
+        LibJS::Benchmark::g_sink = copies[0].encoded();
+        LibJS::Benchmark::report(LibJS::String("value/copy/") + name, samples);
+    }
+
+    // Appends `pieces` short strings one at a time like `html += ...` does, then reads the result once.
+    void benchmarkConcatenation(int32_t pieces) {
+        LibJS::Heap heap;
+        const LibJS::Value piece(LibJS::String("<li>item</li>"));
+        size_t length = 0;
+        const double nanoseconds = LibJS::Benchmark::measureBestNanoseconds(3, [&] {
+            LibJS::Value html(LibJS::String("<ul>"));
+            for (int32_t i = 0; i < pieces; ++i) {
+                html = LibJS::add(html, piece);
+            }
+            length = html.asString().size();
+        });
+        LibJS::Benchmark::g_sink = length;
+        LibJS::Benchmark::report("value/concatenate/" + std::to_string(pieces), nanoseconds / 1e6, "ms");
+    }
+
+}
+
+void LibJS::Benchmark::runValueBenchmarks() {
+    report("value/size", sizeof(LibJS::Value), "bytes");
+
+    LibJS::Heap heap;
+
+    constexpr int32_t iterations = 1'000'000;
+    int32_t counter = 0;
+    benchmarkConstruction("undefined", iterations, [] { return LibJS::Value(); });
+    benchmarkConstruction("int32", iterations, [&] { return LibJS::Value(counter++); });
+    benchmarkConstruction("double", iterations, [&] { return LibJS::Value(0.5 * counter++); });
+    benchmarkConstruction("boolean", iterations, [&] { return LibJS::Value((counter++ & 1) != 0); });
+    // Allocates a cell per value, which is only freed with the heap.
+    benchmarkConstruction("string", 100'000, [] { return LibJS::Value(LibJS::String("LibJS")); });
+
+    benchmarkCopy("int32", LibJS::Value(42));
+    benchmarkCopy("double", LibJS::Value(4.2));
+    benchmarkCopy("boolean", LibJS::Value(true));
+    benchmarkCopy("string", LibJS::Value(LibJS::String("LibJS")));
+
+    benchmarkConcatenation(1'000);
+    benchmarkConcatenation(100'000);
+}
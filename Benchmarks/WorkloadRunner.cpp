@@ -0,0 +1,332 @@
+//
+// End-to-end benchmark driver running the bundled corpus of workload scripts, see LibJS --workloads.
+//
+
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include "WorkloadRunner.h"
+#include "Parser.h"
+
+#if defined(__unix__) || defined(__APPLE__)
+#define LIBJS_WORKLOADS_SUPPORTED 1
+#include <fcntl.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#else
+#define LIBJS_WORKLOADS_SUPPORTED 0
+#endif
+
+namespace {
+
+    const char *modeName(const LibJS::Benchmark::WorkloadOptions &options) {
+        switch (options.mode) {
+            case LibJS::Interpreter::ExecutionMode::AST:
+                return "ast";
+            case LibJS::Interpreter::ExecutionMode::Closure:
+                return "closure";
+            case LibJS::Interpreter::ExecutionMode::Bytecode:
+                return options.jit ? "jit" : "bytecode";
+        }
+        return "unknown";
+    }
+
+    struct BaselineEntry {
+        LibJS::String mode;
+        LibJS::String workload;
+        double seconds;
+        double noisePercent;
+        long peakKiB;
+    };
+
+    LibJS::Vector<BaselineEntry> readBaseline(const LibJS::String &path) {
+        LibJS::Vector<BaselineEntry> entries;
+        std::ifstream file(path);
+        LibJS::String line;
+        while (std::getline(file, line)) {
+            if (line.empty() || line[0] == '#') {
+                continue;
+            }
+            std::istringstream fields(line);
+            BaselineEntry entry;
+            if (fields >> entry.mode >> entry.workload >> entry.seconds >> entry.noisePercent >> entry.peakKiB) {
+                entries.push_back(std::move(entry));
+            }
+        }
+        return entries;
+    }
+
+    bool writeBaseline(const LibJS::String &path, const LibJS::Vector<BaselineEntry> &entries) {
+        std::ofstream file(path);
+        if (!file) {
+            return false;
+        }
+        file << "# <mode> <workload> <median wall time in seconds> <noise in percent> <peak RSS in KiB>, written by "
+                "LibJS --workloads --update-baseline" << std::endl;
+        for (const auto &entry : entries) {
+            file << entry.mode << ' ' << entry.workload << ' ' << entry.seconds << ' ' << entry.noisePercent << ' '
+                 << entry.peakKiB << std::endl;
+        }
+        return static_cast<bool>(file);
+    }
+
+    double median(LibJS::Vector<double> values) {
+        std::sort(values.begin(), values.end());
+        const size_t middle = values.size() / 2;
+        return values.size() % 2 ? values[middle] : (values[middle - 1] + values[middle]) / 2;
+    }
+
+    // What the child process reports back through its pipe: the operations, then the time of every run.
+    using RunResult = LibJS::Vector<double>;
+
+    // Parsing is part of every run, like it is for a script loaded in production.
+    bool runScript(const LibJS::String &source, const LibJS::Benchmark::WorkloadOptions &options, RunResult &result) {
+        result.assign(1, 0);
+        for (int32_t run = 0; run < options.runs; ++run) {
+            const auto start = std::chrono::steady_clock::now();
+            LibJS::Parser parser(source);
+            const auto program = parser.parseProgram();
+            if (parser.hasError()) {
+                std::cerr << parser.error() << std::endl;
+                return false;
+            }
+            LibJS::Interpreter interpreter(options.mode);
+            interpreter.setJitEnabled(options.jit);
+            program->execute(interpreter);
+            if (interpreter.completion() == LibJS::Completion::Throw) {
+                std::cerr << "Uncaught exception: " << interpreter.clearCompletion().toString() << std::endl;
+                return false;
+            }
+            const int32_t slot = program->layout().findSlot(LibJS::Atom::intern("operations"));
+            if (slot >= 0) {
+                result[0] = LibJS::toNumber(interpreter.globalStackFrame().slot(slot));
+            }
+            const auto end = std::chrono::steady_clock::now();
+            result.push_back(std::chrono::duration<double>(end - start).count());
+        }
+        return true;
+    }
+
+    struct Round {
+        RunResult result;
+        long peakKiB;
+    };
+
+    LibJS::Optional<Round> runRound(const LibJS::String &source, const LibJS::Benchmark::WorkloadOptions &options) {
+#if LIBJS_WORKLOADS_SUPPORTED
+        int fds[2];
+        if (pipe(fds) != 0) {
+            return {};
+        }
+        std::cout.flush();
+        const pid_t pid = fork();
+        if (pid < 0) {
+            close(fds[0]);
+            close(fds[1]);
+            return {};
+        }
+        if (pid == 0) {
+            close(fds[0]);
+            const int devNull = open("/dev/null", O_WRONLY);
+            dup2(devNull, STDOUT_FILENO);
+            RunResult result;
+            const auto size = static_cast<ssize_t>(sizeof(double) * (options.runs + 1));
+            const bool succeeded = runScript(source, options, result) && write(fds[1], result.data(), size) == size;
+            _exit(succeeded ? 0 : 1);
+        }
+
+        close(fds[1]);
+        RunResult result(options.runs + 1);
+        const auto size = static_cast<ssize_t>(sizeof(double) * result.size());
+        const bool received = read(fds[0], result.data(), size) == size;
+        close(fds[0]);
+        int status = 0;
+        rusage usage{};
+        if (wait4(pid, &status, 0, &usage) != pid || !WIFEXITED(status) || WEXITSTATUS(status) != 0 || !received) {
+            return {};
+        }
+        return Round{std::move(result), usage.ru_maxrss};
+#else
+        return {};
+#endif
+    }
+
+    struct Measurement {
+        double seconds;
+        // The larger of how far the medians of the rounds are apart and the interquartile range of all runs, in
+        // percent of the median.
+        double noisePercent;
+        double operations;
+        long peakKiB;
+    };
+
+    struct Samples {
+        LibJS::String source;
+        LibJS::Vector<double> times;
+        LibJS::Vector<double> roundMedians;
+        double operations{0};
+        long peakKiB{0};
+        bool failed{false};
+    };
+
+    Measurement summarize(Samples &samples) {
+        Measurement measurement{median(samples.times), 0, samples.operations, samples.peakKiB};
+        std::sort(samples.times.begin(), samples.times.end());
+        const auto [fastest, slowest] = std::minmax_element(samples.roundMedians.begin(), samples.roundMedians.end());
+        const auto &times = samples.times;
+        const double interquartileRange = times[times.size() * 3 / 4] - times[times.size() / 4];
+        measurement.noisePercent = std::max(*slowest - *fastest, interquartileRange) / measurement.seconds * 100;
+        return measurement;
+    }
+
+    // Every round runs each workload once before the next round starts, so the rounds of a workload are spread over
+    // the whole session. A machine that slows down for a while then slows down some rounds of every workload, which
+    // shows in their noise, instead of all rounds of the workloads that happened to run then.
+    LibJS::Vector<LibJS::Optional<Measurement>> measure(const LibJS::Vector<std::filesystem::path> &scripts,
+                                                        const LibJS::Benchmark::WorkloadOptions &options) {
+        LibJS::Vector<Samples> samples(scripts.size());
+        for (size_t i = 0; i < scripts.size(); ++i) {
+            std::ifstream file(scripts[i], std::ios::binary);
+            std::stringstream source;
+            source << file.rdbuf();
+            samples[i].source = source.str();
+            samples[i].failed = !file;
+        }
+
+        for (int32_t round = 0; round < options.rounds; ++round) {
+            for (auto &workload : samples) {
+                if (workload.failed) {
+                    continue;
+                }
+                const auto result = runRound(workload.source, options);
+                if (!result) {
+                    workload.failed = true;
+                    continue;
+                }
+                const LibJS::Vector<double> roundTimes(result->result.begin() + 1, result->result.end());
+                workload.times.insert(workload.times.end(), roundTimes.begin(), roundTimes.end());
+                workload.roundMedians.push_back(median(roundTimes));
+                workload.operations = result->result[0];
+                workload.peakKiB = std::max(workload.peakKiB, result->peakKiB);
+            }
+        }
+
+        LibJS::Vector<LibJS::Optional<Measurement>> measurements;
+        for (auto &workload : samples) {
+            measurements.push_back(workload.failed ? LibJS::Optional<Measurement>{} : summarize(workload));
+        }
+        return measurements;
+    }
+
+    LibJS::String percentChange(double value, double baseline) {
+        std::ostringstream text;
+        text << std::showpos << std::fixed << std::setprecision(1) << (value / baseline - 1) * 100 << '%';
+        return text.str();
+    }
+
+}
+
+int LibJS::Benchmark::runWorkloads(const WorkloadOptions &options) {
+    if (!LIBJS_WORKLOADS_SUPPORTED) {
+        std::cerr << "Workloads run in child processes, which aren't supported on this platform" << std::endl;
+        return 1;
+    }
+    Vector<std::filesystem::path> scripts;
+    std::error_code error;
+    for (const auto &entry : std::filesystem::directory_iterator(options.directory, error)) {
+        if (entry.path().extension() == ".js") {
+            scripts.push_back(entry.path());
+        }
+    }
+    if (error || scripts.empty()) {
+        std::cerr << "No workloads found in " << options.directory << std::endl;
+        return 1;
+    }
+    std::sort(scripts.begin(), scripts.end());
+
+    const String mode = modeName(options);
+    Vector<BaselineEntry> baseline = readBaseline(options.baselinePath);
+    const auto baselineOf = [&](const String &workload) -> BaselineEntry * {
+        auto found = std::find_if(baseline.begin(), baseline.end(), [&](const BaselineEntry &entry) {
+            return entry.mode == mode && entry.workload == workload;
+        });
+        return found != baseline.end() ? &*found : nullptr;
+    };
+
+    std::cout << "Workloads in " << mode << " mode, median of " << options.rounds << " x " << options.runs << " runs"
+              << std::endl;
+    std::cout << std::left << std::setw(12) << "workload" << std::right << std::setw(12) << "time"
+              << std::setw(10) << "noise" << std::setw(14) << "ops/s" << std::setw(14) << "peak RSS"
+              << "   vs baseline" << std::endl;
+
+    const auto measurements = measure(scripts, options);
+    bool failed = false;
+    for (size_t i = 0; i < scripts.size(); ++i) {
+        const String workload = scripts[i].stem().string();
+        std::cout << std::left << std::setw(12) << workload << std::right;
+        const auto &measurement = measurements[i];
+        if (!measurement) {
+            std::cout << "   FAILED" << std::endl;
+            failed = true;
+            continue;
+        }
+        const double seconds = measurement->seconds;
+        std::cout << std::fixed << std::setprecision(3) << std::setw(10) << seconds << " s" << std::setprecision(1)
+                  << std::setw(9) << measurement->noisePercent << '%';
+        if (measurement->operations > 0) {
+            std::cout << std::setprecision(0) << std::setw(14) << measurement->operations / seconds;
+        } else {
+            std::cout << std::setw(14) << "-";
+        }
+        std::cout << std::setw(10) << measurement->peakKiB << " KiB";
+
+        BaselineEntry *entry = baselineOf(workload);
+        if (options.updateBaseline) {
+            if (measurement->noisePercent > options.thresholdPercent) {
+                std::cout << "   too noisy to record, over " << std::setprecision(1) << options.thresholdPercent << '%'
+                          << std::endl;
+                failed = true;
+                continue;
+            }
+            if (!entry) {
+                baseline.push_back({mode, workload, 0, 0, 0});
+                entry = &baseline.back();
+            }
+            entry->seconds = seconds;
+            entry->noisePercent = measurement->noisePercent;
+            entry->peakKiB = measurement->peakKiB;
+            std::cout << "   updated" << std::endl;
+            continue;
+        }
+        if (!entry) {
+            std::cout << "   no baseline" << std::endl;
+            continue;
+        }
+        // Noise can't widen the limit beyond twice the threshold, a slower time than that is a regression however
+        // noisy the machine is.
+        const double noisePercent = std::min(std::max(entry->noisePercent, measurement->noisePercent),
+                                             options.thresholdPercent);
+        const double timeLimit = 1 + (options.thresholdPercent + noisePercent) / 100;
+        const double sizeLimit = 1 + options.thresholdPercent / 100;
+        const bool slower = seconds > entry->seconds * timeLimit;
+        const bool bigger = static_cast<double>(measurement->peakKiB) > static_cast<double>(entry->peakKiB) * sizeLimit;
+        std::cout << "   time " << percentChange(seconds, entry->seconds) << " (limit "
+                  << percentChange(timeLimit, 1) << "), RSS "
+                  << percentChange(static_cast<double>(measurement->peakKiB), static_cast<double>(entry->peakKiB));
+        if (slower || bigger) {
+            std::cout << "   REGRESSION";
+            failed = true;
+        }
+        std::cout << std::endl;
+    }
+
+    if (options.updateBaseline && !writeBaseline(options.baselinePath, baseline)) {
+        std::cerr << "Could not write " << options.baselinePath << std::endl;
+        return 1;
+    }
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,39 @@
+//
+// End-to-end benchmark driver running the bundled corpus of workload scripts, see LibJS --workloads.
+//
+
+#pragma once
+
+#include "Types.h"
+#include "Interpreter.h"
+
+namespace LibJS::Benchmark {
+
+    struct WorkloadOptions {
+        Interpreter::ExecutionMode mode{Interpreter::ExecutionMode::AST};
+        bool jit{true};
+        // Every *.js file in the directory is a workload. A workload sets the global `operations` to the amount of
+        // work it did, that is what ops/s are computed from.
+        String directory;
+        // Lines of "<mode> <workload> <median seconds> <noise percent> <peak RSS KiB>", results are compared with the
+        // entries for the mode they ran in. Only --update-baseline writes it, a machine whose timings differ from the
+        // checked-in ones keeps its own file and passes it with --baseline.
+        String baselinePath;
+        // Bigger than the baseline by more than this many percent counts as a regression. So does slower by more than
+        // this plus the noise of the time, with the noise counting for at most this much again.
+        double thresholdPercent{10};
+        // Replaces the baseline entries of the mode with the new results instead of comparing against them. Results
+        // noisier than the threshold aren't recorded, the entries keep their old values.
+        bool updateBaseline{false};
+        // Each workload runs in this many child processes, this often in each, and its median time counts. Times
+        // move between processes as well as between runs, both spreads go into its noise.
+        int32_t rounds{5};
+        int32_t runs{7};
+    };
+
+    // Every workload runs in a child process of its own, so its peak RSS is measured in isolation and its output
+    // doesn't mix with the report. Returns the exit code for main, 1 if a workload failed or regressed, or right away
+    // on platforms without fork.
+    int runWorkloads(const WorkloadOptions &options);
+
+}
@@ -0,0 +1,24 @@
+// Creates closures and calls them, with captured variables living in environments.
+function makeCounter(step) {
+    var count = 0;
+    function next() {
+        count += step;
+        return count;
+    }
+    return next;
+}
+function makeAdder(x) {
+    function add(y) {
+        return x + y;
+    }
+    return add;
+}
+var total = 0;
+for (var i = 0; i < 10000; i++) {
+    var counter = makeCounter(i);
+    var add = makeAdder(i);
+    for (var j = 0; j < 100; j++) {
+        total = add(counter());
+    }
+}
+var operations = 10000 * 100 * 2;
@@ -0,0 +1,9 @@
+// Recursive calls with int32 arithmetic.
+function fib(n) {
+    if (n < 2) {
+        return n;
+    }
+    return fib(n - 1) + fib(n - 2);
+}
+var result = fib(30);
+var operations = 1346269;
@@ -0,0 +1,61 @@
+// Float arithmetic on object properties, modelled after the n-body simulation.
+function sqrt(x) {
+    var guess = x;
+    if (guess < 1) {
+        guess = 1;
+    }
+    for (var i = 0; i < 12; i++) {
+        guess = 0.5 * (guess + x / guess);
+    }
+    return guess;
+}
+function body(x, y, z, vx, vy, vz, mass) {
+    return { x: x, y: y, z: z, vx: vx, vy: vy, vz: vz, mass: mass };
+}
+function interact(a, b, dt) {
+    var dx = a.x - b.x;
+    var dy = a.y - b.y;
+    var dz = a.z - b.z;
+    var squared = dx * dx + dy * dy + dz * dz;
+    var distance = sqrt(squared);
+    var magnitude = dt / (squared * distance);
+    a.vx -= dx * b.mass * magnitude;
+    a.vy -= dy * b.mass * magnitude;
+    a.vz -= dz * b.mass * magnitude;
+    b.vx += dx * a.mass * magnitude;
+    b.vy += dy * a.mass * magnitude;
+    b.vz += dz * a.mass * magnitude;
+}
+function move(a, dt) {
+    a.x += dt * a.vx;
+    a.y += dt * a.vy;
+    a.z += dt * a.vz;
+}
+function energy(a) {
+    return 0.5 * a.mass * (a.vx * a.vx + a.vy * a.vy + a.vz * a.vz);
+}
+var sun = body(0, 0, 0, 0, 0, 0, 39.47);
+var jupiter = body(4.84, 1.16, 0.1, 0.6, 2.81, 0.02, 0.037);
+var saturn = body(8.34, 4.12, 0.4, 1.01, 1.82, 0.008, 0.011);
+var uranus = body(12.89, 15.11, 0.22, 1.08, 0.86, 0.01, 0.0017);
+var neptune = body(15.37, 25.91, 0.17, 0.97, 0.59, 0.034, 0.002);
+var steps = 20000;
+for (var step = 0; step < steps; step++) {
+    interact(sun, jupiter, 0.01);
+    interact(sun, saturn, 0.01);
+    interact(sun, uranus, 0.01);
+    interact(sun, neptune, 0.01);
+    interact(jupiter, saturn, 0.01);
+    interact(jupiter, uranus, 0.01);
+    interact(jupiter, neptune, 0.01);
+    interact(saturn, uranus, 0.01);
+    interact(saturn, neptune, 0.01);
+    interact(uranus, neptune, 0.01);
+    move(sun, 0.01);
+    move(jupiter, 0.01);
+    move(saturn, 0.01);
+    move(uranus, 0.01);
+    move(neptune, 0.01);
+}
+var total = energy(sun) + energy(jupiter) + energy(saturn) + energy(uranus) + energy(neptune);
+var operations = steps;
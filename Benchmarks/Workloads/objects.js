@@ -0,0 +1,19 @@
+// Allocates binary trees of objects and walks them, exercising the heap and inline caches.
+function build(depth) {
+    if (depth == 0) {
+        return { value: 1, left: null, right: null };
+    }
+    return { value: depth, left: build(depth - 1), right: build(depth - 1) };
+}
+function sum(node) {
+    if (node.left == null) {
+        return node.value;
+    }
+    return node.value + sum(node.left) + sum(node.right);
+}
+var total = 0;
+for (var i = 0; i < 20; i++) {
+    var tree = build(14);
+    total += sum(tree);
+}
+var operations = 20 * 32767 * 2;
@@ -0,0 +1,18 @@
+// String building by repeated concatenation, like templating code does.
+function row(i) {
+    return "<tr><td>" + i + "</td><td>item " + i * 3 + "</td></tr>";
+}
+function table(rows) {
+    var html = "<table>";
+    for (var i = 0; i < rows; i++) {
+        html += row(i);
+    }
+    return html + "</table>";
+}
+var pages = 0;
+var page = "";
+for (var p = 0; p < 600; p++) {
+    page = table(500);
+    pages++;
+}
+var operations = 300000;
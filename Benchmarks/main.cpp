@@ -0,0 +1,49 @@
+//
+// Entry point of the LibJSBench microbenchmarks.
+//
+
+#include <cstring>
+#include <fstream>
+#include "Benchmark.h"
+
+// Usage: LibJSBench [--json <file>] [value] [operator] [interpreter] [parser]. Without groups all of them run. The
+// results are printed as text and, with --json, also written to the file as JSON. The file keeps the output of the
+// interpreter benchmarks' scripts out of the results.
+int main(int argc, char **argv) {
+    const char *jsonPath = nullptr;
+    LibJS::Vector<LibJS::String> groups;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--json") == 0 && i + 1 < argc) {
+            jsonPath = argv[++i];
+        } else {
+            groups.emplace_back(argv[i]);
+        }
+    }
+    const auto selected = [&](const char *group) {
+        return groups.empty() || std::find(groups.begin(), groups.end(), group) != groups.end();
+    };
+
+    if (selected("value")) {
+        LibJS::Benchmark::runValueBenchmarks();
+    }
+    if (selected("operator")) {
+        LibJS::Benchmark::runOperatorBenchmarks();
+    }
+    if (selected("interpreter")) {
+        LibJS::Benchmark::runInterpreterBenchmarks();
+    }
+    if (selected("parser")) {
+        LibJS::Benchmark::runParserBenchmarks();
+    }
+
+    LibJS::Benchmark::printText(std::cout);
+    if (jsonPath) {
+        std::ofstream file(jsonPath);
+        if (!file) {
+            std::cerr << "Could not open " << jsonPath << std::endl;
+            return 1;
+        }
+        LibJS::Benchmark::printJson(file);
+    }
+    return 0;
+}
@@ -0,0 +1,24 @@
+//
+// Heap cell for BigInt values. Arithmetic isn't implemented yet, the cell only keeps the decimal digits.
+//
+
+#pragma once
+
+#include "Cell.h"
+
+namespace LibJS {
+
+    class BigInt final : public Cell {
+    public:
+        explicit BigInt(String digits)
+                : m_digits{std::move(digits)} {}
+
+        String toString() const {
+            return m_digits;
+        }
+
+    private:
+        String m_digits;
+    };
+
+}
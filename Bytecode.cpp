@@ -0,0 +1,114 @@
+//
+// Compact register based bytecode the AST can be compiled to, see ASTNode::generateBytecode and BytecodeVM.
+//
+
+#include "Bytecode.h"
+
+namespace {
+
+    const char *opCodeName(LibJS::Bytecode::OpCode opcode) {
+        using LibJS::Bytecode::OpCode;
+        switch (opcode) {
+            case OpCode::LoadConstant:
+                return "LoadConstant";
+            case OpCode::Move:
+                return "Move";
+            case OpCode::ToNumber:
+                return "ToNumber";
+            case OpCode::GetVariable:
+                return "GetVariable";
+            case OpCode::SetVariable:
+                return "SetVariable";
+            case OpCode::GetGlobal:
+                return "GetGlobal";
+            case OpCode::SetGlobal:
+                return "SetGlobal";
+            case OpCode::Add:
+                return "Add";
+            case OpCode::Subtract:
+                return "Subtract";
+            case OpCode::Divide:
+                return "Divide";
+            case OpCode::Multiply:
+                return "Multiply";
+            case OpCode::Modulo:
+                return "Modulo";
+            case OpCode::Power:
+                return "Power";
+            case OpCode::BitwiseAnd:
+                return "BitwiseAnd";
+            case OpCode::BitwiseOr:
+                return "BitwiseOr";
+            case OpCode::BitwiseXor:
+                return "BitwiseXor";
+            case OpCode::LeftShift:
+                return "LeftShift";
+            case OpCode::RightShift:
+                return "RightShift";
+            case OpCode::Equal:
+                return "Equal";
+            case OpCode::NotEqual:
+                return "NotEqual";
+            case OpCode::GreaterThanOrEqual:
+                return "GreaterThanOrEqual";
+            case OpCode::GreaterThan:
+                return "GreaterThan";
+            case OpCode::LessThan:
+                return "LessThan";
+            case OpCode::LessThanOrEqual:
+                return "LessThanOrEqual";
+            case OpCode::AddConstant:
+                return "AddConstant";
+            case OpCode::SubtractConstant:
+                return "SubtractConstant";
+            case OpCode::JumpIfNotGreaterThanOrEqual:
+                return "JumpIfNotGreaterThanOrEqual";
+            case OpCode::JumpIfNotGreaterThan:
+                return "JumpIfNotGreaterThan";
+            case OpCode::JumpIfNotLessThan:
+                return "JumpIfNotLessThan";
+            case OpCode::JumpIfNotLessThanOrEqual:
+                return "JumpIfNotLessThanOrEqual";
+            case OpCode::Jump:
+                return "Jump";
+            case OpCode::JumpIfFalse:
+                return "JumpIfFalse";
+            case OpCode::NewFunction:
+                return "NewFunction";
+            case OpCode::NewObject:
+                return "NewObject";
+            case OpCode::GetProperty:
+                return "GetProperty";
+            case OpCode::PutProperty:
+                return "PutProperty";
+            case OpCode::Call:
+                return "Call";
+            case OpCode::TailCall:
+                return "TailCall";
+            case OpCode::Return:
+                return "Return";
+            case OpCode::End:
+                return "End";
+        }
+        return "Unknown";
+    }
+
+}
+
+void LibJS::Bytecode::Executable::dump() const {
+    std::cout << "[Executable] registers: " << registerCount << std::endl;
+    for (size_t i = 0; i < instructions.size(); ++i) {
+        const Instruction &instruction = instructions[i];
+        std::cout << "  " << i << ": " << opCodeName(instruction.opcode)
+                  << " a=" << instruction.a
+                  << " b=" << instruction.b
+                  << " c=" << instruction.c
+                  << " d=" << static_cast<int32_t>(instruction.d) << std::endl;
+    }
+    for (size_t i = 0; i < constants.size(); ++i) {
+        std::cout << "  constant " << i << ": " << constants[i].toString() << std::endl;
+    }
+    for (size_t i = 0; i < propertyCaches.size(); ++i) {
+        std::cout << "  property " << i << ": " << propertyCaches[i]->key() << std::endl;
+    }
+}
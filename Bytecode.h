@@ -0,0 +1,311 @@
+//
+// Compact register based bytecode the AST can be compiled to, see ASTNode::generateBytecode and BytecodeVM.
+//
+
+#pragma once
+
+#include <limits>
+#include "Types.h"
+#include "Value.h"
+#include "Operators.h"
+#include "PropertyCache.h"
+
+namespace LibJS {
+    class FunctionDeclaration;
+}
+
+namespace LibJS::Bytecode {
+
+    // Registers index the current stack frame. The first FrameLayout::slotCount() registers are the frame's
+    // variables, temporaries follow after them.
+    using Register = uint16_t;
+
+    enum class OpCode : uint8_t {
+        LoadConstant,   // a = constants[b]
+        Move,           // a = b
+        ToNumber,       // a = ToNumber(b)
+        GetVariable,    // a = captured variable b of the environment d hops up the chain
+        SetVariable,    // captured variable b of the environment d hops up the chain = a
+        GetGlobal,      // a = slot b of the global frame
+        SetGlobal,      // slot b of the global frame = a
+        // The binary operators, a = b op c, in BinaryOperator order.
+        Add,
+        Subtract,
+        Divide,
+        Multiply,
+        Modulo,
+        Power,
+        BitwiseAnd,
+        BitwiseOr,
+        BitwiseXor,
+        LeftShift,
+        RightShift,
+        Equal,
+        NotEqual,
+        GreaterThanOrEqual,
+        GreaterThan,
+        LessThan,
+        LessThanOrEqual,
+        // Superinstructions, the Generator fuses common sequences into them.
+        AddConstant,                    // a = b + constants[c]
+        SubtractConstant,               // a = b - constants[c]
+        // Compare b and c and branch on the result in one go, for a compare into a feeding the JumpIfFalse that
+        // follows. Unless the comparison holds execution continues at the JumpIfFalse's target, otherwise after it.
+        JumpIfNotGreaterThanOrEqual,
+        JumpIfNotGreaterThan,
+        JumpIfNotLessThan,
+        JumpIfNotLessThanOrEqual,
+        Jump,           // continue at target()
+        JumpIfFalse,    // continue at target() unless a is truthy
+        NewFunction,    // a = new function for functions[b]
+        NewObject,      // a = new empty object
+        GetProperty,    // a = b.key, key and inline cache are propertyCaches[c]
+        PutProperty,    // b.key = a, key and inline cache are propertyCaches[c]
+        Call,           // a = call b with d arguments starting at register c
+        TailCall,       // return call b with d arguments starting at register c, reusing the frame
+        Return,         // return a
+        End,            // return undefined
+    };
+
+    static_assert(static_cast<size_t>(OpCode::LessThanOrEqual) - static_cast<size_t>(OpCode::Add) + 1 ==
+                  BinaryOperatorCount);
+
+    constexpr size_t OpCodeCount = static_cast<size_t>(OpCode::End) + 1;
+
+    constexpr OpCode binaryOpCode(BinaryOperator op) {
+        return static_cast<OpCode>(static_cast<uint8_t>(OpCode::Add) + static_cast<uint8_t>(op));
+    }
+
+    constexpr bool isBinaryOpCode(OpCode opcode) {
+        return opcode >= OpCode::Add && opcode <= OpCode::LessThanOrEqual;
+    }
+
+    constexpr bool isCompareJumpOpCode(OpCode opcode) {
+        return opcode >= OpCode::JumpIfNotGreaterThanOrEqual && opcode <= OpCode::JumpIfNotLessThanOrEqual;
+    }
+
+    // Relational operators only, the fused compares keep the operators' order.
+    constexpr OpCode compareJumpOpCode(BinaryOperator op) {
+        assert(op >= BinaryOperator::GreaterThanOrEqual && op <= BinaryOperator::LessThanOrEqual);
+        return static_cast<OpCode>(static_cast<uint8_t>(OpCode::JumpIfNotGreaterThanOrEqual) +
+                                   static_cast<uint8_t>(op) - static_cast<uint8_t>(BinaryOperator::GreaterThanOrEqual));
+    }
+
+    // Whether the opcode applies a binary operator, on its own or as part of a superinstruction.
+    constexpr bool hasBinaryOperator(OpCode opcode) {
+        return isBinaryOpCode(opcode) || opcode == OpCode::AddConstant || opcode == OpCode::SubtractConstant ||
+               isCompareJumpOpCode(opcode);
+    }
+
+    constexpr BinaryOperator binaryOperatorOf(OpCode opcode) {
+        assert(hasBinaryOperator(opcode));
+        if (isBinaryOpCode(opcode)) {
+            return static_cast<BinaryOperator>(static_cast<uint8_t>(opcode) - static_cast<uint8_t>(OpCode::Add));
+        }
+        if (opcode == OpCode::AddConstant) {
+            return BinaryOperator::Add;
+        }
+        if (opcode == OpCode::SubtractConstant) {
+            return BinaryOperator::Subtract;
+        }
+        return static_cast<BinaryOperator>(static_cast<uint8_t>(BinaryOperator::GreaterThanOrEqual) +
+                                           static_cast<uint8_t>(opcode) -
+                                           static_cast<uint8_t>(OpCode::JumpIfNotGreaterThanOrEqual));
+    }
+
+    // Superinstructions whose right operand is a constant instead of a register.
+    constexpr bool hasConstantOperand(OpCode opcode) {
+        return opcode == OpCode::AddConstant || opcode == OpCode::SubtractConstant;
+    }
+
+    struct Instruction {
+        OpCode opcode;
+        uint8_t d{0};
+        Register a{0};
+        Register b{0};
+        Register c{0};
+
+        // Jump targets don't fit into a single 16 bit operand and use b and c together.
+        uint32_t target() const {
+            return static_cast<uint32_t>(b) | (static_cast<uint32_t>(c) << 16);
+        }
+
+        void setTarget(uint32_t target) {
+            b = static_cast<Register>(target & 0xFFFF);
+            c = static_cast<Register>(target >> 16);
+        }
+    };
+
+    static_assert(sizeof(Instruction) == 8);
+
+    struct Executable {
+        Vector<Instruction> instructions;
+        Vector<Value> constants;
+        Vector<FunctionDeclaration *> functions;
+        // Owned by the AST nodes of the access sites, so both execution modes warm up the same caches.
+        Vector<PropertyCache *> propertyCaches;
+        int32_t registerCount{0};
+
+        void dump() const;
+    };
+
+    class Generator final {
+    public:
+        explicit Generator(int32_t variableCount)
+                : m_variableCount{variableCount},
+                  m_nextRegister{variableCount},
+                  m_registerCount{variableCount} {}
+
+        Register allocateRegister() {
+            const auto reg = static_cast<Register>(m_nextRegister++);
+            if (m_nextRegister > m_registerCount) {
+                m_registerCount = m_nextRegister;
+            }
+            return reg;
+        }
+
+        // Temporaries are only live while the statement that produced them is generated, so statements release
+        // everything they allocated once they are done.
+        int32_t registerMark() const { return m_nextRegister; }
+
+        void releaseRegisters(int32_t mark) { m_nextRegister = mark; }
+
+        // Registers below this bound are variables of the current frame.
+        bool isVariable(Register reg) const { return reg < m_variableCount; }
+
+        // Common sequences are fused into superinstructions as they are emitted: a temporary that is only loaded to
+        // be moved somewhere else is written there directly, constant right operands of additions and subtractions
+        // are folded into the instruction and relational compares merge with the conditional jump on their result.
+        void emit(OpCode opcode, Register a = 0, Register b = 0, Register c = 0, uint8_t d = 0) {
+            if (opcode == OpCode::Move) {
+                if (Instruction *producer = producerOf(b); producer && producer->a != a) {
+                    producer->a = a;
+                    return;
+                }
+            } else if (opcode == OpCode::Add || opcode == OpCode::Subtract) {
+                Instruction *load = producerOf(c);
+                if (load && load->opcode == OpCode::LoadConstant && b != c) {
+                    *load = Instruction{opcode == OpCode::Add ? OpCode::AddConstant : OpCode::SubtractConstant, 0, a,
+                                        b, load->b};
+                    return;
+                }
+            }
+            m_executable.instructions.push_back(Instruction{opcode, d, a, b, c});
+        }
+
+        size_t emitJump(OpCode opcode, Register condition = 0) {
+            if (opcode == OpCode::JumpIfFalse) {
+                Instruction *compare = producerOf(condition);
+                if (compare && compare->opcode >= OpCode::GreaterThanOrEqual &&
+                    compare->opcode <= OpCode::LessThanOrEqual) {
+                    compare->opcode = compareJumpOpCode(binaryOperatorOf(compare->opcode));
+                }
+            }
+            emit(opcode, condition);
+            return m_executable.instructions.size() - 1;
+        }
+
+        void patchJump(size_t jump, size_t target) {
+            m_executable.instructions[jump].setTarget(static_cast<uint32_t>(target));
+        }
+
+        // The offset of the next instruction, to be used as a jump target. Instructions are never fused across it.
+        size_t label() {
+            m_label = m_executable.instructions.size();
+            return m_label;
+        }
+
+        // Break and continue jumps are patched once the innermost loop knows where they go.
+        void beginLoop() {
+            m_loops.emplace_back();
+        }
+
+        void emitBreak() {
+            assert(!m_loops.empty());
+            m_loops.back().breaks.push_back(emitJump(OpCode::Jump));
+        }
+
+        void emitContinue() {
+            assert(!m_loops.empty());
+            m_loops.back().continues.push_back(emitJump(OpCode::Jump));
+        }
+
+        void endLoop(size_t continueTarget, size_t breakTarget) {
+            for (const auto jump : m_loops.back().continues) {
+                patchJump(jump, continueTarget);
+            }
+            for (const auto jump : m_loops.back().breaks) {
+                patchJump(jump, breakTarget);
+            }
+            m_loops.pop_back();
+        }
+
+        Register loadConstant(const Value &value) {
+            const Register reg = allocateRegister();
+            emit(OpCode::LoadConstant, reg, addConstant(value));
+            return reg;
+        }
+
+        Register addConstant(const Value &value) {
+            m_executable.constants.push_back(value);
+            return static_cast<Register>(m_executable.constants.size() - 1);
+        }
+
+        Register addFunction(FunctionDeclaration *function) {
+            m_executable.functions.push_back(function);
+            return static_cast<Register>(m_executable.functions.size() - 1);
+        }
+
+        Register addPropertyCache(PropertyCache *cache) {
+            m_executable.propertyCaches.push_back(cache);
+            return static_cast<Register>(m_executable.propertyCaches.size() - 1);
+        }
+
+        // Called by nodes the bytecode can't express yet, the caller then falls back to the AST interpreter.
+        void unsupported() { m_supported = false; }
+
+        Optional<Executable> finish() {
+            constexpr size_t operandLimit = std::numeric_limits<Register>::max();
+            if (!m_supported || static_cast<size_t>(m_registerCount) > operandLimit ||
+                m_executable.constants.size() > operandLimit || m_executable.functions.size() > operandLimit ||
+                m_executable.propertyCaches.size() > operandLimit) {
+                return {};
+            }
+            emit(OpCode::End);
+            m_executable.registerCount = m_registerCount;
+            return std::move(m_executable);
+        }
+
+    private:
+        // The last instruction if it wrote the temporary `reg` and nothing jumps in between it and the next one. Every
+        // temporary is read once by the instruction consuming it, so the write can be redirected or fused into that.
+        Instruction *producerOf(Register reg) {
+            auto &instructions = m_executable.instructions;
+            if (isVariable(reg) || instructions.empty() || m_label == instructions.size()) {
+                return nullptr;
+            }
+            Instruction &last = instructions.back();
+            return writesRegisterA(last.opcode) && last.a == reg ? &last : nullptr;
+        }
+
+        static bool writesRegisterA(OpCode opcode) {
+            return opcode != OpCode::SetVariable && opcode != OpCode::SetGlobal && opcode != OpCode::PutProperty &&
+                   !isCompareJumpOpCode(opcode) && opcode != OpCode::Jump && opcode != OpCode::JumpIfFalse &&
+                   opcode != OpCode::TailCall && opcode != OpCode::Return && opcode != OpCode::End;
+        }
+
+        struct Loop {
+            Vector<size_t> breaks;
+            Vector<size_t> continues;
+        };
+
+        Executable m_executable;
+        Vector<Loop> m_loops;
+        int32_t m_variableCount;
+        int32_t m_nextRegister;
+        int32_t m_registerCount;
+        size_t m_label{0};
+        bool m_supported{true};
+    };
+
+}
@@ -0,0 +1,404 @@
+//
+// Register based virtual machine executing Bytecode::Executables on top of the Interpreter's stack frames.
+//
+
+#include <utility>
+#include "BytecodeVM.h"
+#include "AST.h"
+
+// Computed gotos give every handler its own indirect jump to the next one instead of sharing the switch's, which the
+// branch predictor does a lot better with. They need the labels as values extension of GCC and Clang.
+#if defined(__GNUC__)
+#define LIBJS_THREADED_DISPATCH 1
+#else
+#define LIBJS_THREADED_DISPATCH 0
+#endif
+
+namespace {
+
+    using namespace LibJS;
+    using namespace LibJS::Bytecode;
+
+    constexpr bool isStraightLine(OpCode opcode) {
+        return opcode != OpCode::Jump && opcode != OpCode::JumpIfFalse && !isCompareJumpOpCode(opcode) &&
+               opcode != OpCode::Call &&
+               opcode != OpCode::TailCall && opcode != OpCode::Return && opcode != OpCode::End;
+    }
+
+    // One instantiation per opcode that neither jumps, calls nor returns. The VM inlines them into its dispatch loop,
+    // the JIT calls them through VM::instructionHandler. The compare and branch superinstructions get one as well,
+    // storing the result of their compare into a for the JIT, which compiles them and their JumpIfFalse separately.
+    template<OpCode opcode>
+    [[gnu::always_inline]] inline void execute(Interpreter &interpreter, const Executable &executable,
+                                               Value *registers, const Instruction &instruction) {
+        if constexpr (opcode == OpCode::LoadConstant) {
+            registers[instruction.a] = executable.constants[instruction.b];
+        } else if constexpr (opcode == OpCode::Move) {
+            registers[instruction.a] = registers[instruction.b];
+        } else if constexpr (opcode == OpCode::ToNumber) {
+            const Value &value = registers[instruction.b];
+            registers[instruction.a] = value.isInt() || value.isNumber() ? value : Value(toNumber(value));
+        } else if constexpr (opcode == OpCode::GetVariable) {
+            registers[instruction.a] = interpreter.environmentAt(instruction.d)->slot(instruction.b);
+        } else if constexpr (opcode == OpCode::SetVariable) {
+            interpreter.environmentAt(instruction.d)->slot(instruction.b) = registers[instruction.a];
+        } else if constexpr (opcode == OpCode::GetGlobal) {
+            registers[instruction.a] = interpreter.globalStackFrame().slot(instruction.b);
+        } else if constexpr (opcode == OpCode::SetGlobal) {
+            interpreter.globalStackFrame().slot(instruction.b) = registers[instruction.a];
+        } else if constexpr (hasBinaryOperator(opcode)) {
+            const Value &right = hasConstantOperand(opcode) ? executable.constants[instruction.c]
+                                                            : registers[instruction.c];
+            registers[instruction.a] = binaryOperation(binaryOperatorOf(opcode), registers[instruction.b], right);
+        } else if constexpr (opcode == OpCode::NewFunction) {
+            registers[instruction.a] = executable.functions[instruction.b]->createFunction(interpreter);
+        } else if constexpr (opcode == OpCode::NewObject) {
+            registers[instruction.a] = Value(interpreter.createObject());
+        } else if constexpr (opcode == OpCode::GetProperty) {
+            const Value &object = registers[instruction.b];
+            registers[instruction.a] = object.isObject()
+                                       ? executable.propertyCaches[instruction.c]->get(*object.asObject())
+                                       : Value();
+        } else {
+            static_assert(opcode == OpCode::PutProperty);
+            const Value &object = registers[instruction.b];
+            if (object.isObject()) {
+                executable.propertyCaches[instruction.c]->put(*object.asObject(), registers[instruction.a]);
+            }
+        }
+    }
+
+    // The int32 case of the superinstructions is inlined, the rest shares the operator kernels with the plain opcodes.
+    template<OpCode opcode>
+    [[gnu::always_inline]] inline Value fusedOperation(const Value &left, const Value &right) {
+        constexpr BinaryOperator op = binaryOperatorOf(opcode);
+        if (left.isInt() && right.isInt()) {
+            return int32Operation<op>(left.asInt32(), right.asInt32());
+        }
+        return binaryOperation(op, left, right);
+    }
+
+    template<OpCode opcode>
+    [[gnu::always_inline]] inline void executeWithConstant(const Executable &executable, Value *registers,
+                                                           const Instruction &instruction) {
+        registers[instruction.a] = fusedOperation<opcode>(registers[instruction.b],
+                                                          executable.constants[instruction.c]);
+    }
+
+    // Returns the instruction execution continues at. The JumpIfFalse following the compare carries the target.
+    template<OpCode opcode>
+    [[gnu::always_inline]] inline const Instruction *compareAndJump(const Instruction *instructions,
+                                                                   const Value *registers,
+                                                                   const Instruction *instruction) {
+        if (fusedOperation<opcode>(registers[instruction->b], registers[instruction->c]).asBool()) {
+            return instruction + 2;
+        }
+        return &instructions[instruction[1].target()];
+    }
+
+    template<size_t index>
+    constexpr VM::InstructionHandler handlerAt() {
+        constexpr auto opcode = static_cast<OpCode>(index);
+        if constexpr (isStraightLine(opcode) || isCompareJumpOpCode(opcode)) {
+            return &execute<opcode>;
+        } else {
+            return nullptr;
+        }
+    }
+
+    template<size_t... indices>
+    constexpr std::array<VM::InstructionHandler, OpCodeCount> makeHandlers(std::index_sequence<indices...>) {
+        return {handlerAt<indices>()...};
+    }
+
+    constexpr auto s_handlers = makeHandlers(std::make_index_sequence<OpCodeCount>());
+
+}
+
+LibJS::Bytecode::VM::InstructionHandler LibJS::Bytecode::VM::instructionHandler(OpCode opcode) {
+    return s_handlers[static_cast<size_t>(opcode)];
+}
+
+bool LibJS::Bytecode::VM::call(Interpreter &interpreter, Value *registers, const Instruction &instruction) {
+    // Registers are frame slots, so everything live is rooted here.
+    interpreter.safepoint();
+    const Value callee = registers[instruction.b];
+    if (!interpreter.checkCallable(callee)) {
+        return true;
+    }
+    for (int32_t i = 0; i < instruction.d; ++i) {
+        if (!interpreter.pushArgument(registers[instruction.c + i])) {
+            interpreter.popArguments(i);
+            return true;
+        }
+    }
+    registers[instruction.a] = FunctionDeclaration::call(interpreter, *callee.asFunction(), instruction.d);
+    // The callee ran in the AST interpreter and threw, the bytecode has no handlers to unwind to.
+    return interpreter.isUnwinding();
+}
+
+bool LibJS::Bytecode::VM::tailCall(Interpreter &interpreter, Value *registers, const Instruction &instruction) {
+    interpreter.safepoint();
+    const Value callee = registers[instruction.b];
+    if (!interpreter.checkCallable(callee)) {
+        return true;
+    }
+    for (int32_t i = 0; i < instruction.d; ++i) {
+        if (!interpreter.pushArgument(registers[instruction.c + i])) {
+            interpreter.popArguments(i);
+            return true;
+        }
+    }
+    interpreter.tailCall(callee, instruction.d);
+    return true;
+}
+
+#if LIBJS_THREADED_DISPATCH
+
+LibJS::Value LibJS::Bytecode::VM::run(const Executable &executable) {
+    // In OpCode order.
+    static constexpr void *dispatchTable[] = {
+            &&LoadConstant, &&Move, &&ToNumber, &&GetVariable, &&SetVariable, &&GetGlobal, &&SetGlobal,
+            &&Add, &&Subtract, &&Divide, &&Multiply, &&Modulo, &&Power, &&BitwiseAnd, &&BitwiseOr, &&BitwiseXor,
+            &&LeftShift, &&RightShift, &&Equal, &&NotEqual, &&GreaterThanOrEqual, &&GreaterThan, &&LessThan,
+            &&LessThanOrEqual, &&AddConstant, &&SubtractConstant, &&JumpIfNotGreaterThanOrEqual,
+            &&JumpIfNotGreaterThan, &&JumpIfNotLessThan, &&JumpIfNotLessThanOrEqual, &&Jump, &&JumpIfFalse,
+            &&NewFunction, &&NewObject, &&GetProperty, &&PutProperty, &&Call, &&TailCall, &&Return, &&End,
+    };
+    static_assert(std::size(dispatchTable) == OpCodeCount);
+
+    Value *registers = m_interpreter.currentStackFrame().registers();
+    const Instruction *instructions = executable.instructions.data();
+    const Instruction *instruction = instructions;
+    goto *dispatchTable[static_cast<size_t>(instruction->opcode)];
+
+LoadConstant:
+    execute<OpCode::LoadConstant>(m_interpreter, executable, registers, *instruction);
+    goto *dispatchTable[static_cast<size_t>((++instruction)->opcode)];
+Move:
+    execute<OpCode::Move>(m_interpreter, executable, registers, *instruction);
+    goto *dispatchTable[static_cast<size_t>((++instruction)->opcode)];
+ToNumber:
+    execute<OpCode::ToNumber>(m_interpreter, executable, registers, *instruction);
+    goto *dispatchTable[static_cast<size_t>((++instruction)->opcode)];
+GetVariable:
+    execute<OpCode::GetVariable>(m_interpreter, executable, registers, *instruction);
+    goto *dispatchTable[static_cast<size_t>((++instruction)->opcode)];
+SetVariable:
+    execute<OpCode::SetVariable>(m_interpreter, executable, registers, *instruction);
+    goto *dispatchTable[static_cast<size_t>((++instruction)->opcode)];
+GetGlobal:
+    execute<OpCode::GetGlobal>(m_interpreter, executable, registers, *instruction);
+    goto *dispatchTable[static_cast<size_t>((++instruction)->opcode)];
+SetGlobal:
+    execute<OpCode::SetGlobal>(m_interpreter, executable, registers, *instruction);
+    goto *dispatchTable[static_cast<size_t>((++instruction)->opcode)];
+Add:
+    execute<OpCode::Add>(m_interpreter, executable, registers, *instruction);
+    goto *dispatchTable[static_cast<size_t>((++instruction)->opcode)];
+Subtract:
+    execute<OpCode::Subtract>(m_interpreter, executable, registers, *instruction);
+    goto *dispatchTable[static_cast<size_t>((++instruction)->opcode)];
+Divide:
+    execute<OpCode::Divide>(m_interpreter, executable, registers, *instruction);
+    goto *dispatchTable[static_cast<size_t>((++instruction)->opcode)];
+Multiply:
+    execute<OpCode::Multiply>(m_interpreter, executable, registers, *instruction);
+    goto *dispatchTable[static_cast<size_t>((++instruction)->opcode)];
+Modulo:
+    execute<OpCode::Modulo>(m_interpreter, executable, registers, *instruction);
+    goto *dispatchTable[static_cast<size_t>((++instruction)->opcode)];
+Power:
+    execute<OpCode::Power>(m_interpreter, executable, registers, *instruction);
+    goto *dispatchTable[static_cast<size_t>((++instruction)->opcode)];
+BitwiseAnd:
+    execute<OpCode::BitwiseAnd>(m_interpreter, executable, registers, *instruction);
+    goto *dispatchTable[static_cast<size_t>((++instruction)->opcode)];
+BitwiseOr:
+    execute<OpCode::BitwiseOr>(m_interpreter, executable, registers, *instruction);
+    goto *dispatchTable[static_cast<size_t>((++instruction)->opcode)];
+BitwiseXor:
+    execute<OpCode::BitwiseXor>(m_interpreter, executable, registers, *instruction);
+    goto *dispatchTable[static_cast<size_t>((++instruction)->opcode)];
+LeftShift:
+    execute<OpCode::LeftShift>(m_interpreter, executable, registers, *instruction);
+    goto *dispatchTable[static_cast<size_t>((++instruction)->opcode)];
+RightShift:
+    execute<OpCode::RightShift>(m_interpreter, executable, registers, *instruction);
+    goto *dispatchTable[static_cast<size_t>((++instruction)->opcode)];
+Equal:
+    execute<OpCode::Equal>(m_interpreter, executable, registers, *instruction);
+    goto *dispatchTable[static_cast<size_t>((++instruction)->opcode)];
+NotEqual:
+    execute<OpCode::NotEqual>(m_interpreter, executable, registers, *instruction);
+    goto *dispatchTable[static_cast<size_t>((++instruction)->opcode)];
+GreaterThanOrEqual:
+    execute<OpCode::GreaterThanOrEqual>(m_interpreter, executable, registers, *instruction);
+    goto *dispatchTable[static_cast<size_t>((++instruction)->opcode)];
+GreaterThan:
+    execute<OpCode::GreaterThan>(m_interpreter, executable, registers, *instruction);
+    goto *dispatchTable[static_cast<size_t>((++instruction)->opcode)];
+LessThan:
+    execute<OpCode::LessThan>(m_interpreter, executable, registers, *instruction);
+    goto *dispatchTable[static_cast<size_t>((++instruction)->opcode)];
+LessThanOrEqual:
+    execute<OpCode::LessThanOrEqual>(m_interpreter, executable, registers, *instruction);
+    goto *dispatchTable[static_cast<size_t>((++instruction)->opcode)];
+AddConstant:
+    executeWithConstant<OpCode::AddConstant>(executable, registers, *instruction);
+    goto *dispatchTable[static_cast<size_t>((++instruction)->opcode)];
+SubtractConstant:
+    executeWithConstant<OpCode::SubtractConstant>(executable, registers, *instruction);
+    goto *dispatchTable[static_cast<size_t>((++instruction)->opcode)];
+JumpIfNotGreaterThanOrEqual:
+    instruction = compareAndJump<OpCode::JumpIfNotGreaterThanOrEqual>(instructions, registers, instruction);
+    goto *dispatchTable[static_cast<size_t>(instruction->opcode)];
+JumpIfNotGreaterThan:
+    instruction = compareAndJump<OpCode::JumpIfNotGreaterThan>(instructions, registers, instruction);
+    goto *dispatchTable[static_cast<size_t>(instruction->opcode)];
+JumpIfNotLessThan:
+    instruction = compareAndJump<OpCode::JumpIfNotLessThan>(instructions, registers, instruction);
+    goto *dispatchTable[static_cast<size_t>(instruction->opcode)];
+JumpIfNotLessThanOrEqual:
+    instruction = compareAndJump<OpCode::JumpIfNotLessThanOrEqual>(instructions, registers, instruction);
+    goto *dispatchTable[static_cast<size_t>(instruction->opcode)];
+NewFunction:
+    execute<OpCode::NewFunction>(m_interpreter, executable, registers, *instruction);
+    goto *dispatchTable[static_cast<size_t>((++instruction)->opcode)];
+NewObject:
+    execute<OpCode::NewObject>(m_interpreter, executable, registers, *instruction);
+    goto *dispatchTable[static_cast<size_t>((++instruction)->opcode)];
+GetProperty:
+    execute<OpCode::GetProperty>(m_interpreter, executable, registers, *instruction);
+    goto *dispatchTable[static_cast<size_t>((++instruction)->opcode)];
+PutProperty:
+    execute<OpCode::PutProperty>(m_interpreter, executable, registers, *instruction);
+    goto *dispatchTable[static_cast<size_t>((++instruction)->opcode)];
+Jump:
+    m_interpreter.safepoint();
+    instruction = &instructions[instruction->target()];
+    goto *dispatchTable[static_cast<size_t>(instruction->opcode)];
+JumpIfFalse:
+    instruction = registers[instruction->a].toBoolean() ? instruction + 1 : &instructions[instruction->target()];
+    goto *dispatchTable[static_cast<size_t>(instruction->opcode)];
+Call:
+    if (call(m_interpreter, registers, *instruction)) {
+        return {};
+    }
+    goto *dispatchTable[static_cast<size_t>((++instruction)->opcode)];
+TailCall:
+    tailCall(m_interpreter, registers, *instruction);
+    return {};
+Return:
+    return registers[instruction->a];
+End:
+    return {};
+}
+
+#else
+
+LibJS::Value LibJS::Bytecode::VM::run(const Executable &executable) {
+    Value *registers = m_interpreter.currentStackFrame().registers();
+    const Instruction *instructions = executable.instructions.data();
+    const Instruction *next = instructions;
+
+    for (;;) {
+        const Instruction &instruction = *next++;
+        switch (instruction.opcode) {
+            case OpCode::LoadConstant:
+                execute<OpCode::LoadConstant>(m_interpreter, executable, registers, instruction);
+                break;
+            case OpCode::Move:
+                execute<OpCode::Move>(m_interpreter, executable, registers, instruction);
+                break;
+            case OpCode::ToNumber:
+                execute<OpCode::ToNumber>(m_interpreter, executable, registers, instruction);
+                break;
+            case OpCode::GetVariable:
+                execute<OpCode::GetVariable>(m_interpreter, executable, registers, instruction);
+                break;
+            case OpCode::SetVariable:
+                execute<OpCode::SetVariable>(m_interpreter, executable, registers, instruction);
+                break;
+            case OpCode::GetGlobal:
+                execute<OpCode::GetGlobal>(m_interpreter, executable, registers, instruction);
+                break;
+            case OpCode::SetGlobal:
+                execute<OpCode::SetGlobal>(m_interpreter, executable, registers, instruction);
+                break;
+            case OpCode::Add:
+            case OpCode::Subtract:
+            case OpCode::Divide:
+            case OpCode::Multiply:
+            case OpCode::Modulo:
+            case OpCode::Power:
+            case OpCode::BitwiseAnd:
+            case OpCode::BitwiseOr:
+            case OpCode::BitwiseXor:
+            case OpCode::LeftShift:
+            case OpCode::RightShift:
+            case OpCode::Equal:
+            case OpCode::NotEqual:
+            case OpCode::GreaterThanOrEqual:
+            case OpCode::GreaterThan:
+            case OpCode::LessThan:
+            case OpCode::LessThanOrEqual:
+                registers[instruction.a] = binaryOperation(binaryOperatorOf(instruction.opcode),
+                                                           registers[instruction.b], registers[instruction.c]);
+                break;
+            case OpCode::AddConstant:
+                executeWithConstant<OpCode::AddConstant>(executable, registers, instruction);
+                break;
+            case OpCode::SubtractConstant:
+                executeWithConstant<OpCode::SubtractConstant>(executable, registers, instruction);
+                break;
+            case OpCode::JumpIfNotGreaterThanOrEqual:
+                next = compareAndJump<OpCode::JumpIfNotGreaterThanOrEqual>(instructions, registers, &instruction);
+                break;
+            case OpCode::JumpIfNotGreaterThan:
+                next = compareAndJump<OpCode::JumpIfNotGreaterThan>(instructions, registers, &instruction);
+                break;
+            case OpCode::JumpIfNotLessThan:
+                next = compareAndJump<OpCode::JumpIfNotLessThan>(instructions, registers, &instruction);
+                break;
+            case OpCode::JumpIfNotLessThanOrEqual:
+                next = compareAndJump<OpCode::JumpIfNotLessThanOrEqual>(instructions, registers, &instruction);
+                break;
+            case OpCode::NewFunction:
+                execute<OpCode::NewFunction>(m_interpreter, executable, registers, instruction);
+                break;
+            case OpCode::NewObject:
+                execute<OpCode::NewObject>(m_interpreter, executable, registers, instruction);
+                break;
+            case OpCode::GetProperty:
+                execute<OpCode::GetProperty>(m_interpreter, executable, registers, instruction);
+                break;
+            case OpCode::PutProperty:
+                execute<OpCode::PutProperty>(m_interpreter, executable, registers, instruction);
+                break;
+            case OpCode::Jump:
+                m_interpreter.safepoint();
+                next = &instructions[instruction.target()];
+                break;
+            case OpCode::JumpIfFalse:
+                if (!registers[instruction.a].toBoolean()) {
+                    next = &instructions[instruction.target()];
+                }
+                break;
+            case OpCode::Call:
+                if (call(m_interpreter, registers, instruction)) {
+                    return {};
+                }
+                break;
+            case OpCode::TailCall:
+                tailCall(m_interpreter, registers, instruction);
+                return {};
+            case OpCode::Return:
+                return registers[instruction.a];
+            case OpCode::End:
+                return {};
+        }
+    }
+}
+
+#endif
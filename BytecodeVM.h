@@ -0,0 +1,39 @@
+//
+// Register based virtual machine executing Bytecode::Executables on top of the Interpreter's stack frames.
+//
+
+#pragma once
+
+#include "Bytecode.h"
+#include "Interpreter.h"
+
+namespace LibJS::Bytecode {
+
+    class VM final {
+    public:
+        explicit VM(Interpreter &interpreter)
+                : m_interpreter{interpreter} {}
+
+        // Runs the executable in the interpreter's current stack frame, which must hold its registers. Calls go through
+        // FunctionDeclaration::call.
+        Value run(const Executable &executable);
+
+        using InstructionHandler = void (*)(Interpreter &interpreter, const Executable &executable, Value *registers,
+                                            const Instruction &instruction);
+
+        // The VM's implementation of an opcode that neither jumps, calls nor returns, nullptr for the others. The JIT
+        // calls these for everything it doesn't inline. For the compare and branch superinstructions it is the compare
+        // alone, storing the result into a.
+        static InstructionHandler instructionHandler(OpCode opcode);
+
+        // Call and TailCall, also shared with the JIT. Both return whether the interpreter is unwinding, in which case
+        // the executable has to return right away.
+        static bool call(Interpreter &interpreter, Value *registers, const Instruction &instruction);
+
+        static bool tailCall(Interpreter &interpreter, Value *registers, const Instruction &instruction);
+
+    private:
+        Interpreter &m_interpreter;
+    };
+
+}
@@ -0,0 +1,58 @@
+//
+// Base class for every heap allocated runtime object a Value can point to.
+//
+
+#pragma once
+
+#include "Types.h"
+
+namespace LibJS {
+
+    class Heap;
+
+    class Cell {
+    public:
+        // Collects the cells reachable from the roots. Visiting a cell only marks it, its edges are traced later from
+        // the mark stack so deep object graphs don't recurse.
+        class Visitor final {
+        public:
+            void visit(Cell *cell) {
+                if (cell && !cell->m_marked) {
+                    cell->m_marked = true;
+                    m_markStack.push_back(cell);
+                }
+            }
+
+        private:
+            friend class Heap;
+
+            Vector<Cell *> m_markStack;
+        };
+
+        Cell() = default;
+
+        Cell(const Cell &) = delete;
+
+        Cell &operator=(const Cell &) = delete;
+
+        virtual ~Cell() = default;
+
+        // Cells that keep other cells alive have to report them here.
+        virtual void visitEdges(Visitor &) {}
+
+        // For cells whose memory is owned by something else, like string literals in a Program's arena. They stay
+        // marked forever, so the collector never traces or sweeps them.
+        void makeImmortal() {
+            m_marked = true;
+        }
+
+        bool isMarked() const { return m_marked; }
+
+    private:
+        friend class Heap;
+
+        Cell *m_nextCell{nullptr};
+        bool m_marked{false};
+    };
+
+}
@@ -0,0 +1,586 @@
+//
+// Binary serialization of parsed programs and the on-disk cache built on it, see LibJS --code-cache.
+//
+
+#include <bit>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <limits>
+#include <sstream>
+#include "CodeCache.h"
+#include "AST.h"
+#include "Parser.h"
+
+#if defined(__unix__) || defined(__APPLE__)
+#define LIBJS_CODE_CACHE_MMAP 1
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#else
+#define LIBJS_CODE_CACHE_MMAP 0
+#endif
+
+namespace {
+
+    using namespace LibJS;
+
+    // "LJSC", the format version, the source's hash and its length and the hash of the rest of the file, fixed size and
+    // little endian. The last one catches a damaged file, which could otherwise still decode to a different tree.
+    constexpr uint8_t Magic[4] = {'L', 'J', 'S', 'C'};
+    constexpr size_t HeaderSize = 4 + 4 + 8 + 8 + 8;
+
+    enum class ValueTag : uint8_t {
+        Undefined,
+        Null,
+        False,
+        True,
+        Int32,
+        Double,
+        String
+    };
+
+    void appendFixed(Vector<uint8_t> &bytes, uint64_t value, size_t size) {
+        for (size_t i = 0; i < size; ++i) {
+            bytes.push_back(static_cast<uint8_t>(value >> (8 * i)));
+        }
+    }
+
+    uint64_t hashBytes(Span<const uint8_t> bytes) {
+        return CodeCache::hash(std::string_view(reinterpret_cast<const char *>(bytes.data()), bytes.size()));
+    }
+
+    uint64_t readFixed(const uint8_t *bytes, size_t size) {
+        uint64_t value = 0;
+        for (size_t i = 0; i < size; ++i) {
+            value |= static_cast<uint64_t>(bytes[i]) << (8 * i);
+        }
+        return value;
+    }
+
+    // Whether a node of `kind` is a T, which saves a dynamic_cast per node.
+    template<typename T>
+    constexpr bool isKindOf(NodeKind kind) {
+        if constexpr (std::is_same_v<T, Statement>) {
+            switch (kind) {
+                case NodeKind::BlockStatement:
+                case NodeKind::FunctionDeclaration:
+                case NodeKind::ExpressionStatement:
+                case NodeKind::VariableDeclaration:
+                case NodeKind::ReturnStatement:
+                case NodeKind::IfStatement:
+                case NodeKind::WhileStatement:
+                case NodeKind::ForStatement:
+                case NodeKind::BreakStatement:
+                case NodeKind::ContinueStatement:
+                case NodeKind::ThrowStatement:
+                case NodeKind::TryStatement:
+                    return true;
+                default:
+                    return false;
+            }
+        } else if constexpr (std::is_same_v<T, Expression>) {
+            switch (kind) {
+                case NodeKind::Identifier:
+                case NodeKind::Literal:
+                case NodeKind::CallExpression:
+                case NodeKind::ObjectExpression:
+                case NodeKind::MemberExpression:
+                case NodeKind::BinaryExpression:
+                case NodeKind::AssignmentExpression:
+                    return true;
+                default:
+                    return false;
+            }
+        } else if constexpr (std::is_same_v<T, Identifier>) {
+            return kind == NodeKind::Identifier;
+        } else if constexpr (std::is_same_v<T, BlockStatement>) {
+            return kind == NodeKind::BlockStatement;
+        } else if constexpr (std::is_same_v<T, Property>) {
+            return kind == NodeKind::Property;
+        } else {
+            static_assert(std::is_same_v<T, VariableDeclarator>);
+            return kind == NodeKind::VariableDeclarator;
+        }
+    }
+
+    // Reads what ASTWriter wrote. Every read is bounds checked, a truncated or corrupt entry makes the reader fail
+    // instead of building a broken tree.
+    class ASTReader final {
+    public:
+        explicit ASTReader(Span<const uint8_t> data)
+                : m_data{data} {}
+
+        bool failed() const { return m_failed; }
+
+        bool atEnd() const { return m_position == m_data.size(); }
+
+        void setProgram(Program &program) { m_program = &program; }
+
+        void fail() { m_failed = true; }
+
+        uint8_t readByte() {
+            if (m_position >= m_data.size()) {
+                fail();
+                return 0;
+            }
+            return m_data[m_position++];
+        }
+
+        bool readBool() { return readByte() != 0; }
+
+        uint64_t readUnsigned() {
+            uint64_t value = 0;
+            for (int32_t shift = 0; shift < 64; shift += 7) {
+                const uint8_t byte = readByte();
+                value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+                if (!(byte & 0x80)) {
+                    return value;
+                }
+            }
+            fail();
+            return 0;
+        }
+
+        int64_t readSigned() {
+            const uint64_t value = readUnsigned();
+            return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+        }
+
+        // Enums are checked against their last enumerator.
+        template<typename Enum>
+        Enum readEnum(Enum last) {
+            const uint64_t value = readUnsigned();
+            if (value > static_cast<uint64_t>(last)) {
+                fail();
+                return Enum{};
+            }
+            return static_cast<Enum>(value);
+        }
+
+        // The strings stay in the mapped file, only names are interned.
+        void readStringTable() {
+            const uint64_t count = readUnsigned();
+            if (count > m_data.size()) {
+                fail();
+                return;
+            }
+            m_strings.reserve(count);
+            m_atoms.resize(count);
+            for (uint64_t i = 0; i < count && !m_failed; ++i) {
+                const uint64_t length = readUnsigned();
+                if (length > m_data.size() - m_position) {
+                    fail();
+                    return;
+                }
+                m_strings.emplace_back(reinterpret_cast<const char *>(&m_data[m_position]), length);
+                m_position += length;
+            }
+        }
+
+        std::string_view readString() {
+            const uint64_t index = readUnsigned();
+            if (index >= m_strings.size()) {
+                fail();
+                return {};
+            }
+            return m_strings[index];
+        }
+
+        Atom readAtom() {
+            const uint64_t index = readUnsigned();
+            if (index >= m_strings.size()) {
+                fail();
+                return {};
+            }
+            if (!m_atoms[index]) {
+                m_atoms[index] = Atom::intern(m_strings[index]);
+            }
+            return *m_atoms[index];
+        }
+
+        Value readValue() {
+            switch (readEnum(ValueTag::String)) {
+                case ValueTag::Undefined:
+                    return JsUndefined();
+                case ValueTag::Null:
+                    return Value::null();
+                case ValueTag::False:
+                    return Value(false);
+                case ValueTag::True:
+                    return Value(true);
+                case ValueTag::Int32: {
+                    const int64_t value = readSigned();
+                    if (value < std::numeric_limits<int32_t>::min() || value > std::numeric_limits<int32_t>::max()) {
+                        fail();
+                        return {};
+                    }
+                    return Value(static_cast<int32_t>(value));
+                }
+                case ValueTag::Double: {
+                    if (m_data.size() - m_position < 8) {
+                        fail();
+                        return {};
+                    }
+                    const uint64_t bits = readFixed(&m_data[m_position], 8);
+                    m_position += 8;
+                    return Value(std::bit_cast<double>(bits));
+                }
+                case ValueTag::String:
+                    return m_program->makeString(String(readString()));
+            }
+            return {};
+        }
+
+        // The kind is checked against T before the node is read, a node of the wrong type makes the reader fail.
+        template<typename T>
+        T *readNode() {
+            if (m_failed) {
+                return nullptr;
+            }
+            const NodeKind kind = readEnum(NodeKind::TryStatement);
+            if (!isKindOf<T>(kind)) {
+                fail();
+                return nullptr;
+            }
+            // Nesting is bounded by what the parser accepts, a corrupt entry can't overflow the stack.
+            if (++m_depth > MaxDepth) {
+                fail();
+                return nullptr;
+            }
+            ASTNode *node = readNodeOfKind(kind);
+            --m_depth;
+            return m_failed ? nullptr : static_cast<T *>(node);
+        }
+
+        template<typename T>
+        T *readOptionalNode() {
+            if (m_position < m_data.size() && m_data[m_position] == static_cast<uint8_t>(NodeKind::Null)) {
+                ++m_position;
+                return nullptr;
+            }
+            return readNode<T>();
+        }
+
+        template<typename T>
+        Span<T *> readNodes() {
+            const uint64_t count = readUnsigned();
+            if (count > m_data.size() - m_position) {
+                fail();
+                return {};
+            }
+            Vector<T *> nodes;
+            nodes.reserve(count);
+            for (uint64_t i = 0; i < count && !m_failed; ++i) {
+                nodes.push_back(readNode<T>());
+            }
+            return m_program->makeArray(nodes);
+        }
+
+    private:
+        // A tree the parser accepts is at most a few nodes deep per level of nesting: declarators, properties and
+        // the blocks of functions and try statements aren't levels of their own.
+        static constexpr int32_t MaxDepth = 4 * Parser::MaxNestingDepth;
+
+        // Children are read in the order ASTNode::serialize wrote them, so they are read into locals first instead
+        // of straight into constructor arguments, whose evaluation order is unspecified.
+        ASTNode *readNodeOfKind(NodeKind kind) {
+            Program &program = *m_program;
+            switch (kind) {
+                case NodeKind::Null:
+                case NodeKind::Program:
+                    fail();
+                    return nullptr;
+                case NodeKind::BlockStatement:
+                    return program.make<BlockStatement>(readNodes<Statement>());
+                case NodeKind::Identifier:
+                    return program.make<Identifier>(readAtom());
+                case NodeKind::FunctionDeclaration: {
+                    auto *id = readNode<Identifier>();
+                    const auto params = readNodes<Identifier>();
+                    auto *body = readNode<BlockStatement>();
+                    return program.make<FunctionDeclaration>(id, params, body);
+                }
+                case NodeKind::Literal:
+                    return program.make<Literal>(readValue());
+                case NodeKind::CallExpression: {
+                    auto *callee = readNode<Expression>();
+                    return program.make<CallExpression>(callee, readNodes<Expression>());
+                }
+                case NodeKind::Property: {
+                    const Atom key = readAtom();
+                    return program.make<Property>(key, readNode<Expression>());
+                }
+                case NodeKind::ObjectExpression:
+                    return program.make<ObjectExpression>(readNodes<Property>());
+                case NodeKind::MemberExpression: {
+                    auto *object = readNode<Expression>();
+                    return program.make<MemberExpression>(object, readAtom());
+                }
+                case NodeKind::BinaryExpression: {
+                    const auto op = readEnum(BinaryOperator::LessThanOrEqual);
+                    auto *left = readNode<Expression>();
+                    auto *right = readNode<Expression>();
+                    return program.make<BinaryExpression>(op, left, right);
+                }
+                case NodeKind::ExpressionStatement:
+                    return program.make<ExpressionStatement>(readNode<Expression>());
+                case NodeKind::VariableDeclarator: {
+                    auto *id = readNode<Expression>();
+                    auto *init = readNode<Expression>();
+                    return program.make<VariableDeclarator>(id, init);
+                }
+                case NodeKind::VariableDeclaration: {
+                    const auto declarationKind = readEnum(VariableDeclaration::Kind::Let);
+                    return program.make<VariableDeclaration>(declarationKind, readNodes<VariableDeclarator>());
+                }
+                case NodeKind::ReturnStatement: {
+                    auto *argument = readNode<Expression>();
+                    return program.make<ReturnStatement>(argument, readBool());
+                }
+                case NodeKind::AssignmentExpression: {
+                    const auto op = readEnum(AssignmentExpression::AssignmentOperator::Decrement);
+                    auto *left = readNode<Expression>();
+                    auto *right = readNode<Expression>();
+                    return program.make<AssignmentExpression>(op, left, right, readBool());
+                }
+                case NodeKind::IfStatement: {
+                    auto *test = readNode<Expression>();
+                    auto *consequent = readNode<Statement>();
+                    auto *alternate = readOptionalNode<Statement>();
+                    return program.make<IfStatement>(test, consequent, alternate);
+                }
+                case NodeKind::WhileStatement: {
+                    auto *test = readNode<Expression>();
+                    return program.make<WhileStatement>(test, readNode<Statement>());
+                }
+                case NodeKind::ForStatement: {
+                    auto *init = readOptionalNode<Statement>();
+                    auto *test = readOptionalNode<Expression>();
+                    auto *update = readOptionalNode<Expression>();
+                    return program.make<ForStatement>(init, test, update, readNode<Statement>());
+                }
+                case NodeKind::BreakStatement:
+                    return program.make<BreakStatement>();
+                case NodeKind::ContinueStatement:
+                    return program.make<ContinueStatement>();
+                case NodeKind::ThrowStatement:
+                    return program.make<ThrowStatement>(readNode<Expression>());
+                case NodeKind::TryStatement: {
+                    auto *block = readNode<BlockStatement>();
+                    auto *parameter = readOptionalNode<Identifier>();
+                    auto *handler = readOptionalNode<BlockStatement>();
+                    auto *finalizer = readOptionalNode<BlockStatement>();
+                    return program.make<TryStatement>(block, parameter, handler, finalizer);
+                }
+            }
+            fail();
+            return nullptr;
+        }
+
+        Span<const uint8_t> m_data;
+        size_t m_position{0};
+        Program *m_program{nullptr};
+        Vector<std::string_view> m_strings;
+        Vector<Optional<Atom>> m_atoms;
+        int32_t m_depth{0};
+        bool m_failed{false};
+    };
+
+#if !LIBJS_CODE_CACHE_MMAP
+    Optional<Vector<uint8_t>> readFile(const String &path) {
+        std::ifstream file(path, std::ios::binary);
+        if (!file) {
+            return {};
+        }
+        std::stringstream contents;
+        contents << file.rdbuf();
+        const String text = contents.str();
+        return Vector<uint8_t>(text.begin(), text.end());
+    }
+#endif
+
+    // Unique per process, so concurrent stores of the same entry don't write to the same file.
+    LibJS::String temporaryPathFor(const LibJS::String &path) {
+#if LIBJS_CODE_CACHE_MMAP
+        return path + ".tmp" + std::to_string(getpid());
+#else
+        return path + ".tmp";
+#endif
+    }
+
+}
+
+void LibJS::ASTWriter::writeString(std::string_view string) {
+    auto found = m_stringIndices.find(String(string));
+    if (found == m_stringIndices.end()) {
+        found = m_stringIndices.emplace(String(string), static_cast<uint32_t>(m_strings.size())).first;
+        m_strings.emplace_back(string);
+    }
+    writeUnsigned(found->second);
+}
+
+void LibJS::ASTWriter::writeValue(const Value &value) {
+    if (value.isUndefined()) {
+        m_nodes.push_back(static_cast<uint8_t>(ValueTag::Undefined));
+    } else if (value.isNull()) {
+        m_nodes.push_back(static_cast<uint8_t>(ValueTag::Null));
+    } else if (value.isBoolean()) {
+        m_nodes.push_back(static_cast<uint8_t>(value.asBool() ? ValueTag::True : ValueTag::False));
+    } else if (value.isInt()) {
+        m_nodes.push_back(static_cast<uint8_t>(ValueTag::Int32));
+        writeSigned(value.asInt32());
+    } else if (value.isNumber()) {
+        m_nodes.push_back(static_cast<uint8_t>(ValueTag::Double));
+        appendFixed(m_nodes, std::bit_cast<uint64_t>(value.asDouble()), 8);
+    } else if (value.isString()) {
+        m_nodes.push_back(static_cast<uint8_t>(ValueTag::String));
+        writeString(value.asString());
+    } else {
+        unsupported();
+    }
+}
+
+void LibJS::ASTWriter::writeNode(const ASTNode *node) {
+    if (!node) {
+        writeKind(NodeKind::Null);
+        return;
+    }
+    node->serialize(*this);
+}
+
+Vector<uint8_t> LibJS::ASTWriter::finish(uint64_t sourceHash, uint64_t sourceLength) const {
+    Vector<uint8_t> payload;
+    writeUnsigned(payload, m_strings.size());
+    for (const auto &string : m_strings) {
+        writeUnsigned(payload, string.size());
+        payload.insert(payload.end(), string.begin(), string.end());
+    }
+    payload.insert(payload.end(), m_nodes.begin(), m_nodes.end());
+
+    Vector<uint8_t> bytes(std::begin(Magic), std::end(Magic));
+    appendFixed(bytes, CodeCache::FormatVersion, 4);
+    appendFixed(bytes, sourceHash, 8);
+    appendFixed(bytes, sourceLength, 8);
+    appendFixed(bytes, hashBytes(payload), 8);
+    bytes.insert(bytes.end(), payload.begin(), payload.end());
+    return bytes;
+}
+
+uint64_t LibJS::CodeCache::hash(std::string_view source) {
+    // Eight bytes a step, hashing the source is part of every load and has to stay far below the cost of a parse.
+    // Words are little endian like every other number in the file, a byte swap on big endian machines.
+    constexpr uint64_t Multiplier = 0x9e3779b97f4a7c15;
+    const auto littleEndian = [](uint64_t word) {
+        if constexpr (std::endian::native == std::endian::big) {
+            return __builtin_bswap64(word);
+        }
+        return word;
+    };
+    uint64_t hash = source.size();
+    size_t offset = 0;
+    for (; offset + 8 <= source.size(); offset += 8) {
+        uint64_t word;
+        std::memcpy(&word, source.data() + offset, 8);
+        hash = (std::rotl(hash, 5) ^ littleEndian(word)) * Multiplier;
+    }
+    uint64_t tail = 0;
+    std::memcpy(&tail, source.data() + offset, source.size() - offset);
+    hash = (std::rotl(hash, 5) ^ littleEndian(tail)) * Multiplier;
+    return hash ^ (hash >> 32);
+}
+
+Optional<Vector<uint8_t>> LibJS::CodeCache::serialize(const Program &program, std::string_view source) {
+    ASTWriter writer;
+    program.serialize(writer);
+    if (!writer.isSupported()) {
+        return {};
+    }
+    return writer.finish(hash(source), source.size());
+}
+
+UniquePtr<Program> LibJS::CodeCache::deserialize(Span<const uint8_t> data, std::string_view source) {
+    if (data.size() < HeaderSize || !std::equal(std::begin(Magic), std::end(Magic), data.begin()) ||
+        readFixed(&data[4], 4) != FormatVersion || readFixed(&data[8], 8) != hash(source) ||
+        readFixed(&data[16], 8) != source.size()) {
+        return nullptr;
+    }
+    const auto payload = data.subspan(HeaderSize);
+    if (readFixed(&data[24], 8) != hashBytes(payload)) {
+        return nullptr;
+    }
+    ASTReader reader(payload);
+    reader.readStringTable();
+    if (reader.readEnum(NodeKind::TryStatement) != NodeKind::Program) {
+        return nullptr;
+    }
+    auto program = std::make_unique<Program>(reader.readEnum(Program::SourceType::Module));
+    reader.setProgram(*program);
+    for (auto *statement : reader.readNodes<Statement>()) {
+        program->append(statement);
+    }
+    if (reader.failed() || !reader.atEnd()) {
+        return nullptr;
+    }
+    return program;
+}
+
+String LibJS::CodeCache::pathFor(std::string_view source) const {
+    char name[32];
+    std::snprintf(name, sizeof(name), "%016llx.ljsc", static_cast<unsigned long long>(hash(source)));
+    return (std::filesystem::path(m_directory) / name).string();
+}
+
+UniquePtr<Program> LibJS::CodeCache::load(std::string_view source) const {
+    const String path = pathFor(source);
+#if LIBJS_CODE_CACHE_MMAP
+    const int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return nullptr;
+    }
+    struct stat status{};
+    if (fstat(fd, &status) != 0 || status.st_size == 0) {
+        close(fd);
+        return nullptr;
+    }
+    const auto size = static_cast<size_t>(status.st_size);
+    void *mapping = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (mapping == MAP_FAILED) {
+        return nullptr;
+    }
+    auto program = deserialize(Span<const uint8_t>(static_cast<const uint8_t *>(mapping), size), source);
+    munmap(mapping, size);
+    return program;
+#else
+    const auto data = readFile(path);
+    return data ? deserialize(*data, source) : nullptr;
+#endif
+}
+
+bool LibJS::CodeCache::store(const Program &program, std::string_view source) const {
+    const auto data = serialize(program, source);
+    if (!data) {
+        return false;
+    }
+    std::error_code error;
+    std::filesystem::create_directories(m_directory, error);
+    const String path = pathFor(source);
+    const String temporaryPath = temporaryPathFor(path);
+    {
+        std::ofstream file(temporaryPath, std::ios::binary | std::ios::trunc);
+        file.write(reinterpret_cast<const char *>(data->data()), static_cast<std::streamsize>(data->size()));
+        if (!file) {
+            std::filesystem::remove(temporaryPath, error);
+            return false;
+        }
+    }
+    std::filesystem::rename(temporaryPath, path, error);
+    if (error) {
+        std::filesystem::remove(temporaryPath, error);
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,135 @@
+//
+// Binary serialization of parsed programs and the on-disk cache built on it, see LibJS --code-cache.
+//
+
+#pragma once
+
+#include <string_view>
+#include "Types.h"
+#include "Atom.h"
+#include "Value.h"
+
+namespace LibJS {
+
+    class ASTNode;
+    class Program;
+
+    // Tags the nodes in the serialized tree. Null stands for a missing optional child.
+    enum class NodeKind : uint8_t {
+        Null,
+        Program,
+        BlockStatement,
+        Identifier,
+        FunctionDeclaration,
+        Literal,
+        CallExpression,
+        Property,
+        ObjectExpression,
+        MemberExpression,
+        BinaryExpression,
+        ExpressionStatement,
+        VariableDeclarator,
+        VariableDeclaration,
+        ReturnStatement,
+        AssignmentExpression,
+        IfStatement,
+        WhileStatement,
+        ForStatement,
+        BreakStatement,
+        ContinueStatement,
+        ThrowStatement,
+        TryStatement
+    };
+
+    // Writes a tree in preorder: every node is its kind followed by its fields and children, see ASTNode::serialize.
+    // Integers are LEB128 encoded and names and strings are indices into a table written ahead of the nodes, so a
+    // name costs its characters once per program.
+    class ASTWriter final {
+    public:
+        void writeKind(NodeKind kind) { m_nodes.push_back(static_cast<uint8_t>(kind)); }
+
+        void writeBool(bool value) { m_nodes.push_back(value ? 1 : 0); }
+
+        void writeUnsigned(uint64_t value) { writeUnsigned(m_nodes, value); }
+
+        // Zigzag encoded, small negative numbers stay short.
+        void writeSigned(int64_t value) {
+            writeUnsigned((static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63));
+        }
+
+        void writeString(std::string_view string);
+
+        void writeAtom(Atom atom) { writeString(atom.string()); }
+
+        // Literal values only, cells other than strings can't be serialized.
+        void writeValue(const Value &value);
+
+        // Null nodes are written as NodeKind::Null.
+        void writeNode(const ASTNode *node);
+
+        // A count followed by the nodes.
+        template<typename Nodes>
+        void writeNodes(const Nodes &nodes) {
+            writeUnsigned(nodes.size());
+            for (const auto &node : nodes) {
+                writeNode(node);
+            }
+        }
+
+        // Called by nodes the format doesn't cover, the program can't be cached then.
+        void unsupported() { m_supported = false; }
+
+        bool isSupported() const { return m_supported; }
+
+        // The header, the string table and the nodes.
+        Vector<uint8_t> finish(uint64_t sourceHash, uint64_t sourceLength) const;
+
+        static void writeUnsigned(Vector<uint8_t> &bytes, uint64_t value) {
+            while (value >= 0x80) {
+                bytes.push_back(static_cast<uint8_t>(value | 0x80));
+                value >>= 7;
+            }
+            bytes.push_back(static_cast<uint8_t>(value));
+        }
+
+    private:
+        Vector<uint8_t> m_nodes;
+        Vector<String> m_strings;
+        HashSet<String, uint32_t> m_stringIndices;
+        bool m_supported{true};
+    };
+
+    // Parsed programs stored on disk, named by a hash of their source. Loading one maps the file and builds the tree in
+    // a single pass over it, without lexing or parsing. An entry is only used if the format version, the source's hash
+    // and length and the entry's own hash all match, anything else is a miss and is overwritten by the next store.
+    class CodeCache final {
+    public:
+        static constexpr uint32_t FormatVersion = 1;
+
+        explicit CodeCache(String directory)
+                : m_directory{std::move(directory)} {}
+
+        // Of sources and of the serialized trees. Not a standard hash: eight bytes a step, each read as a little endian
+        // word, rotated into the state and multiplied by the 64 bit golden ratio, so a cache file means the same on
+        // every machine. Fast, not cryptographic, a source crafted to collide with a cached one would run its tree.
+        static uint64_t hash(std::string_view source);
+
+        static Optional<Vector<uint8_t>> serialize(const Program &program, std::string_view source);
+
+        // nullptr if the data isn't a valid serialization of the source.
+        static UniquePtr<Program> deserialize(Span<const uint8_t> data, std::string_view source);
+
+        String pathFor(std::string_view source) const;
+
+        // nullptr on a miss.
+        UniquePtr<Program> load(std::string_view source) const;
+
+        // False if the program can't be serialized or the entry couldn't be written. Entries are written to a
+        // temporary file first and renamed, a concurrent load never sees half of one.
+        bool store(const Program &program, std::string_view source) const;
+
+    private:
+        String m_directory;
+    };
+
+}
@@ -0,0 +1,104 @@
+//
+// Precise mark-sweep garbage collector owning every Cell created at runtime.
+//
+
+#pragma once
+
+#include <algorithm>
+#include "Types.h"
+#include "Cell.h"
+#include "RuntimeStats.h"
+#include "Log.h"
+
+namespace LibJS {
+
+    class Heap final {
+    public:
+        // Constructing a heap makes it the current one of this thread until it is destroyed.
+        Heap() : m_previous{s_current} {
+            s_current = this;
+        }
+
+        Heap(const Heap &) = delete;
+
+        Heap &operator=(const Heap &) = delete;
+
+        ~Heap() {
+            assert(s_current == this);
+            s_current = m_previous;
+            while (m_cells) {
+                Cell *next = m_cells->m_nextCell;
+                delete m_cells;
+                m_cells = next;
+            }
+        }
+
+        static Heap &current() {
+            assert(s_current);
+            return *s_current;
+        }
+
+        // Never collects by itself, allocating only requests a collection that runs at the next safepoint.
+        template<typename T, typename... Args>
+        T *allocate(Args &&... args) {
+            T *cell = new T(std::forward<Args>(args)...);
+            cell->m_nextCell = m_cells;
+            m_cells = cell;
+            ++m_cellCount;
+            RuntimeStats::recordAllocation<T>();
+            return cell;
+        }
+
+        bool shouldCollect() const { return m_cellCount >= m_collectionThreshold; }
+
+        // visitRoots(Cell::Visitor &) has to visit every cell the caller still uses.
+        template<typename Callback>
+        void collectGarbage(Callback visitRoots) {
+            Cell::Visitor visitor;
+            visitRoots(visitor);
+            while (!visitor.m_markStack.empty()) {
+                Cell *cell = visitor.m_markStack.back();
+                visitor.m_markStack.pop_back();
+                cell->visitEdges(visitor);
+            }
+            const size_t cellCount = m_cellCount;
+            sweep();
+            ++m_collectionCount;
+            m_collectionThreshold = std::max(InitialCollectionThreshold, m_cellCount * 2);
+            Log::debug(Log::Category::Heap, [&](std::ostream &out) {
+                out << "collection " << m_collectionCount << " freed " << cellCount - m_cellCount << " cells, "
+                    << m_cellCount << " live";
+            });
+        }
+
+        size_t cellCount() const { return m_cellCount; }
+
+        size_t collectionCount() const { return m_collectionCount; }
+
+    private:
+        static constexpr size_t InitialCollectionThreshold = 4096;
+
+        void sweep() {
+            Cell **link = &m_cells;
+            while (Cell *cell = *link) {
+                if (cell->m_marked) {
+                    cell->m_marked = false;
+                    link = &cell->m_nextCell;
+                } else {
+                    *link = cell->m_nextCell;
+                    delete cell;
+                    --m_cellCount;
+                }
+            }
+        }
+
+        static inline thread_local Heap *s_current{nullptr};
+
+        Heap *m_previous;
+        Cell *m_cells{nullptr};
+        size_t m_cellCount{0};
+        size_t m_collectionThreshold{InitialCollectionThreshold};
+        size_t m_collectionCount{0};
+    };
+
+}
@@ -0,0 +1,58 @@
+//
+// Native stack bounds of the thread running the interpreter, see Interpreter::nativeStackLimit.
+//
+
+#include <algorithm>
+#include "Interpreter.h"
+
+#if defined(__linux__) || defined(__APPLE__)
+#include <pthread.h>
+#elif defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#endif
+
+namespace {
+
+    // Assumed where the thread's stack can't be queried, the smallest default main thread stack, Windows' 1 MiB.
+    constexpr uintptr_t FallbackStackSize = 1 << 20;
+
+    // The lowest address of the current thread's stack, 0 if it is unknown.
+    uintptr_t stackLowAddress() {
+#if defined(__linux__)
+        uintptr_t low = 0;
+        pthread_attr_t attributes;
+        if (pthread_getattr_np(pthread_self(), &attributes) == 0) {
+            void *address;
+            size_t size;
+            if (pthread_attr_getstack(&attributes, &address, &size) == 0) {
+                low = reinterpret_cast<uintptr_t>(address);
+            }
+            pthread_attr_destroy(&attributes);
+        }
+        return low;
+#elif defined(__APPLE__)
+        const auto high = reinterpret_cast<uintptr_t>(pthread_get_stackaddr_np(pthread_self()));
+        return high - pthread_get_stacksize_np(pthread_self());
+#elif defined(_WIN32)
+        ULONG_PTR low;
+        ULONG_PTR high;
+        GetCurrentThreadStackLimits(&low, &high);
+        return low;
+#else
+        return 0;
+#endif
+    }
+
+}
+
+uintptr_t LibJS::Interpreter::nativeStackLimit() {
+    const char marker{};
+    const auto here = reinterpret_cast<uintptr_t>(&marker);
+    uintptr_t low = stackLowAddress();
+    if (low == 0 || low >= here) {
+        low = here > FallbackStackSize ? here - FallbackStackSize : 0;
+    }
+    return low + std::min<uintptr_t>(NativeStackReserve, (here - low) / 2);
+}
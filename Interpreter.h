@@ -4,82 +4,268 @@
 
 #pragma once
 
+#include <algorithm>
+#include <string_view>
 #include "Types.h"
 #include "Value.h"
+#include "ScopeAnalysis.h"
+#include "RuntimeStats.h"
 
 namespace LibJS {
 
     class FunctionDeclaration;
+    class ASTNode;
 
+    // A window into the interpreter's value stack. Bytecode registers live behind the variable slots.
     class StackFrame final {
     public:
-        Optional <Value> getVariable(const String &name) {
-            auto foundVariable = m_variables.find(name);
-            if (foundVariable != m_variables.end()) {
-                return foundVariable->second;
-            }
-            return {};
+        StackFrame(const FrameLayout *layout, Environment *environment, Value *slots, int32_t slotCount)
+                : m_slots{slots},
+                  m_slotCount{slotCount},
+                  m_layout{layout},
+                  m_environment{environment} {}
+
+        Value &slot(int32_t index) {
+            assert(index < m_slotCount);
+            return m_slots[index];
+        }
+
+        // The value stack never moves, so the pointer stays valid while frames are pushed on top.
+        Value *registers() {
+            return m_slots;
         }
 
-        Value &setVariable(const String &id, Value value) {
-            return m_variables[id] = value;
+        int32_t slotCount() const { return m_slotCount; }
+
+        // The global frame is created before the program is analyzed and grows to the program's layout.
+        void setLayout(const FrameLayout *layout, int32_t slotCount) {
+            m_layout = layout;
+            m_slotCount = std::max(m_slotCount, slotCount);
         }
 
+        // The frame's own environment if it has captured variables, otherwise the one of the function it runs.
+        Environment *environment() const { return m_environment; }
+
+        // nullptr for the global frame until the program is entered.
+        const FrameLayout *layout() const { return m_layout; }
+
+#if LIBJS_PROFILE_NODES
+        // The statement the frame is executing in the tree-walking and closure tiers, see Interpreter::enterStatement.
+        const ASTNode *executingNode() const { return m_executingNode; }
+
+        void setExecutingNode(const ASTNode *node) { m_executingNode = node; }
+#endif
+
         void dump() const {
             std::cout << "<----------------->" << std::endl;
-            for (const auto &var : m_variables) {
-                std::cout << var.first << ": " << var.second.toString() << std::endl;
+            const int32_t slotCount = m_layout ? m_layout->slotCount() : 0;
+            for (int32_t i = 0; i < slotCount; ++i) {
+                if (m_layout->isBlockScoped(i)) {
+                    continue;
+                }
+                std::cout << m_layout->slotName(i) << ": " << m_slots[i].toString() << std::endl;
             }
         }
 
     private:
-        HashSet <String, Value> m_variables;
+        Value *m_slots;
+        int32_t m_slotCount;
+        const FrameLayout *m_layout;
+        Environment *m_environment;
+#if LIBJS_PROFILE_NODES
+        const ASTNode *m_executingNode{nullptr};
+#endif
+    };
+
+    // How the last statement completed. Anything but Normal unwinds: statement lists stop, loops consume Break and
+    // Continue, calls consume Return and TailCall and try statements consume Throw.
+    enum class Completion : uint8_t {
+        Normal,
+        Return,
+        Break,
+        Continue,
+        Throw,
+        TailCall
     };
 
     class Interpreter final {
     public:
+        // Closure runs the tree compiled once into bound callables, see ASTNode::compile.
+        enum class ExecutionMode {
+            AST,
+            Closure,
+            Bytecode
+        };
+
+        // Both stacks are allocated once up front, frames never move and pushing one doesn't allocate. Running out of
+        // either throws a RangeError instead of growing them, and so does running low on native stack, which depends
+        // on the tier and the build and usually runs out first.
+        static constexpr int32_t StackFrameCapacity = 1 << 14;
+        // Room for 32 slots in every frame.
+        static constexpr int32_t ValueStackCapacity = StackFrameCapacity * 32;
+        // Native stack kept free below the limit for recursion that doesn't push a frame: expressions nested as deep
+        // as the parser allows, compiling a function on its first call and the profiler's signal handler. At most half
+        // of the thread's stack.
+        static constexpr size_t NativeStackReserve = 1 << 20;
+
+        explicit Interpreter(ExecutionMode mode = ExecutionMode::AST)
+                : m_valueStack(ValueStackCapacity),
+                  m_emptyShape{m_heap.allocate<Shape>()},
+                  m_executionMode{mode} {
+            m_stackFrames.reserve(StackFrameCapacity);
+            m_stackFrames.emplace_back(nullptr, nullptr, m_valueStack.data(), 0); // Global Scope;
+        }
+
+        ExecutionMode executionMode() const { return m_executionMode; }
+
+        // In bytecode mode hot functions are compiled to machine code, see JIT::compile. While the JIT is off every
+        // call runs in the VM, also those of functions that were compiled before.
+        bool isJitEnabled() const { return m_jitEnabled; }
+
+        void setJitEnabled(bool enabled) { m_jitEnabled = enabled; }
+
+        Heap &heap() { return m_heap; }
+
+        // Counters are only kept in builds with LIBJS_RUNTIME_STATS, see RuntimeStats.
+        RuntimeStats &stats() { return m_stats; }
+
+        const RuntimeStats &stats() const { return m_stats; }
+
+        // All objects start out with the same empty shape, so objects built the same way share their shapes.
+        Object *createObject() {
+            return m_heap.allocate<Object>(m_emptyShape);
+        }
 
-        Interpreter() {
-            m_stackFrames.emplace_back(StackFrame()); // Global Scope;
+        // Marks the statement the current frame executes, so the profiler can attribute samples to it. Compiles to
+        // nothing unless built with LIBJS_PROFILE_NODES.
+        void enterStatement([[maybe_unused]] const ASTNode *statement) {
+#if LIBJS_PROFILE_NODES
+            m_stackFrames.back().setExecutingNode(statement);
+#endif
         }
 
-        Optional <Value> getVariable(const String &name) {
-            if (m_stackFrames.empty()) {
-                return {};
+        // Collections only happen at safepoints, where every live Value is either in a stack frame or a temporary.
+        void safepoint() {
+            if (m_heap.shouldCollect()) {
+                collectGarbage();
             }
+        }
 
-            for (int32_t i = m_stackFrames.size() - 1; i >= 0; --i) {
-                StackFrame &currentStackFrame = m_stackFrames[i];
-                auto value = currentStackFrame.getVariable(name);
-                if (value.has_value()) {
-                    return value;
+        void collectGarbage() {
+            const RuntimeStats::PhaseScope phase(RuntimeStats::Phase::GarbageCollection);
+            m_stats.recordCollection();
+            m_heap.collectGarbage([this](Cell::Visitor &visitor) {
+                visitor.visit(m_emptyShape);
+                for (int32_t i = 0; i < m_stackTop; ++i) {
+                    m_valueStack[i].visitEdges(visitor);
+                }
+                for (const auto &frame : m_stackFrames) {
+                    visitor.visit(frame.environment());
                 }
+                for (const auto &value : m_temporaries) {
+                    value.visitEdges(visitor);
+                }
+                m_completionValue.visitEdges(visitor);
+            });
+        }
+
+        // Values the tree-walker holds in C++ locals while evaluating other nodes have to be pushed here, evaluating
+        // a node can reach a safepoint.
+        void pushTemporary(const Value &value) {
+            m_temporaries.push_back(value);
+        }
+
+        void popTemporaries(size_t count) {
+            m_temporaries.resize(m_temporaries.size() - count);
+        }
+
+        Value getVariable(const VariableLocation &location) {
+            m_stats.recordVariableLookup();
+            if (!location.isResolved()) {
+                return {}; // Add to global scope?
             }
+            return variable(location);
+        }
 
-            return {}; // Add to global scope?
+        Value &setVariable(const VariableLocation &location, const Value &value) {
+            assert(location.isResolved());
+            m_stats.recordVariableLookup();
+            return variable(location) = value;
         }
 
+        void enterProgram(const FrameLayout &layout, int32_t registerCount = 0) {
+            assert(m_stackFrames.size() == 1);
+            const int32_t slotCount = std::max(layout.slotCount(), registerCount);
+            StackFrame &global = m_stackFrames.front();
+            for (int32_t i = global.slotCount(); i < slotCount; ++i) {
+                m_valueStack[i] = {};
+            }
+            global.setLayout(&layout, slotCount);
+            m_stackTop = global.slotCount();
+            m_nativeStackLimit = nativeStackLimit();
+        }
+
+        // Calling convention: the caller pushes the arguments onto the value stack, where they become the first
+        // slots of the callee's frame, so parameters are bound without copying. Arguments beyond the parameters
+        // are dropped, missing ones and all other slots start out undefined. Returns false and throws if the value
+        // stack is full, the caller then drops the arguments it already pushed.
+        bool pushArgument(const Value &value) {
+            if (m_stackTop >= ValueStackCapacity) {
+                throwStackOverflow();
+                return false;
+            }
+            m_valueStack[m_stackTop++] = value;
+            return true;
+        }
 
-        Value& declareVariable(const String &id, const Value &value) {
-            return m_stackFrames[m_stackFrames.size() - 1].setVariable(id, value);
+        // Drops arguments that were pushed for a call that never happened, because evaluating one of them threw.
+        void popArguments(int32_t count) {
+            m_stackTop -= count;
         }
 
-        Value& setVariable(const String &id, const Value &value) {
-            for (int32_t i = m_stackFrames.size() - 1; i >= 0; --i) {
-                StackFrame &currentStackFrame = m_stackFrames[i];
-                if (currentStackFrame.getVariable(id).has_value()) {
-                    return currentStackFrame.setVariable(id, value);
+        // Frames whose layout has captured variables allocate their environment up front, chained to the environment
+        // the called function closed over. Returns false and throws if either stack is full, the arguments are dropped
+        // then.
+        bool pushStackFrame(const FrameLayout &layout, Environment *closure, int32_t argumentCount = 0,
+                            int32_t registerCount = 0) {
+            const int32_t base = m_stackTop - argumentCount;
+            const int32_t slotCount = std::max(layout.slotCount(), registerCount);
+            if (m_stackFrames.size() >= StackFrameCapacity || slotCount > ValueStackCapacity - base ||
+                isNativeStackExhausted()) {
+                m_stackTop = base;
+                throwStackOverflow();
+                return false;
+            }
+            m_stats.recordStackFramePush();
+            for (int32_t i = base + std::min(argumentCount, layout.parameterCount()); i < base + slotCount; ++i) {
+                m_valueStack[i] = {};
+            }
+            Environment *environment = closure;
+            if (layout.environmentSize() > 0) {
+                environment = m_heap.allocate<Environment>(layout.environmentSize(), closure);
+                for (const auto &parameter : layout.capturedParameters()) {
+                    environment->slot(parameter.index) = m_valueStack[base + parameter.slot];
                 }
             }
-            assert(false);
+            m_stackFrames.emplace_back(&layout, environment, &m_valueStack[base], slotCount);
+            m_stackTop = base + slotCount;
+            return true;
         }
 
-        void pushStackFrame() {
-            m_stackFrames.emplace_back(StackFrame{});
+        void popStackFrame() {
+            m_stackTop = static_cast<int32_t>(m_stackFrames.back().registers() - m_valueStack.data());
+            m_stackFrames.pop_back();
         }
 
-        void popStackFrame() {
+        // Pops the current frame but moves the pending tail call's arguments down to where it started, ready for the
+        // callee's frame to be pushed in its place. Returns the number of arguments.
+        int32_t popStackFrameForTailCall() {
+            const int32_t argumentCount = m_tailCallArgumentCount;
+            Value *base = m_stackFrames.back().registers();
+            std::copy(&m_valueStack[m_stackTop - argumentCount], &m_valueStack[m_stackTop], base);
             m_stackFrames.pop_back();
+            m_stackTop = static_cast<int32_t>(base - m_valueStack.data()) + argumentCount;
+            return argumentCount;
         }
 
         void dumpStack() const {
@@ -91,12 +277,147 @@ namespace LibJS {
             std::cout << "End Stack Dump:" << std::endl;
         }
 
+        // Abrupt completions are signalled through the interpreter instead of C++ exceptions, every node that runs
+        // children checks isUnwinding() after them. Unwinding costs a branch per level, not a stack unwind.
+        bool isUnwinding() const { return m_completion != Completion::Normal; }
+
+        Completion completion() const { return m_completion; }
+
         void returnFromStackFrame(const Value &value) {
+            complete(Completion::Return, value);
+        }
+
+        void breakLoop() {
+            complete(Completion::Break, {});
+        }
+
+        void continueLoop() {
+            complete(Completion::Continue, {});
+        }
+
+        void throwException(const Value &value) {
+            complete(Completion::Throw, value);
+        }
+
+        // There are no error objects yet, runtime errors throw their name and message as a string, which scripts
+        // catch like any other thrown value.
+        void throwError(std::string_view name, std::string_view message) {
+            throwException(Value(String(name) + ": " + String(message)));
+        }
+
+        // Throws a TypeError unless `callee` can be called, every tier checks this before pushing the arguments.
+        bool checkCallable(const Value &callee) {
+            if (callee.isFunction()) {
+                return true;
+            }
+            throwError("TypeError", callee.toString() + " is not a function");
+            return false;
+        }
+
+        // The arguments are already on top of the value stack, see popStackFrameForTailCall.
+        void tailCall(const Value &callee, int32_t argumentCount) {
+            m_tailCallArgumentCount = argumentCount;
+            complete(Completion::TailCall, callee);
+        }
+
+        // Ends the unwinding and hands out the returned or thrown value.
+        Value clearCompletion() {
+            m_completion = Completion::Normal;
+            const Value value = m_completionValue;
+            m_completionValue = {};
+            return value;
+        }
+
+        // Restores a completion that was set aside while a finally block ran.
+        void complete(Completion completion, const Value &value) {
+            m_completion = completion;
+            m_completionValue = value;
+        }
+
+        StackFrame &currentStackFrame() {
+            return m_stackFrames.back();
+        }
+
+        StackFrame &globalStackFrame() {
+            return m_stackFrames.front();
+        }
+
+        // Outermost frame first. Frames are never moved, the profiler reads them from its signal handler.
+        Span<const StackFrame> stackFrames() const {
+            return m_stackFrames;
+        }
+
+        // Walks `hops` links up the chain, starting at the current frame's environment.
+        Environment *environmentAt(int32_t hops) {
+            m_stats.recordEnvironmentLookup(hops);
+            Environment *environment = m_stackFrames.back().environment();
+            for (int32_t i = 0; i < hops; ++i) {
+                environment = environment->parent();
+            }
+            return environment;
+        }
+
+    private:
+        // The lowest address the stack pointer of the calling thread may reach while calls still push frames, taken
+        // when the program is entered. The stack grows down on every platform the runtime builds for.
+        static uintptr_t nativeStackLimit();
+
+        bool isNativeStackExhausted() const {
+            const char marker{};
+            return reinterpret_cast<uintptr_t>(&marker) < m_nativeStackLimit;
+        }
+
+        void throwStackOverflow() {
+            throwError("RangeError", "Maximum call stack size exceeded");
+        }
+
+        Value &variable(const VariableLocation &location) {
+            switch (location.kind) {
+                case VariableLocation::Kind::Local:
+                    return m_stackFrames.back().slot(location.index);
+                case VariableLocation::Kind::Global:
+                    return m_stackFrames.front().slot(location.index);
+                default:
+                    assert(location.kind == VariableLocation::Kind::Environment);
+                    return environmentAt(location.hops)->slot(location.index);
+            }
+        }
+
+        // Declared first so that it outlives everything that refers to its cells.
+        Heap m_heap;
+        RuntimeStats m_stats;
+        Vector<Value> m_valueStack;
+        int32_t m_stackTop{0};
+        Vector<StackFrame> m_stackFrames;
+        Vector<Value> m_temporaries;
+        Shape *m_emptyShape;
+        ExecutionMode m_executionMode;
+        bool m_jitEnabled{true};
+        Completion m_completion{Completion::Normal};
+        Value m_completionValue;
+        int32_t m_tailCallArgumentCount{0};
+        // No limit until a program is entered.
+        uintptr_t m_nativeStackLimit{0};
+    };
+
+    // Keeps a single temporary alive until the end of the C++ scope.
+    class TemporaryRoot final {
+    public:
+        TemporaryRoot(Interpreter &interpreter, const Value &value)
+                : m_interpreter{interpreter} {
+            m_interpreter.pushTemporary(value);
+        }
+
+        TemporaryRoot(const TemporaryRoot &) = delete;
+
+        TemporaryRoot &operator=(const TemporaryRoot &) = delete;
 
+        ~TemporaryRoot() {
+            m_interpreter.popTemporaries(1);
         }
 
     private:
-        Vector <StackFrame> m_stackFrames;
+        Interpreter &m_interpreter;
     };
 
 }
@@ -0,0 +1,669 @@
+//
+// Baseline template JIT translating the bytecode of hot functions into x86-64 machine code.
+//
+
+#include <cstring>
+#include <utility>
+#include "JIT.h"
+#include "BytecodeVM.h"
+#include "Interpreter.h"
+
+#if defined(__x86_64__) && defined(__linux__)
+#define LIBJS_JIT_SUPPORTED 1
+#include <sys/mman.h>
+#else
+#define LIBJS_JIT_SUPPORTED 0
+#endif
+
+namespace {
+
+    using namespace LibJS;
+    using namespace LibJS::Bytecode;
+
+#if LIBJS_JIT_SUPPORTED
+
+    enum Reg : uint8_t {
+        RAX = 0,
+        RCX = 1,
+        RDX = 2,
+        RBX = 3,
+        RSP = 4,
+        RBP = 5,
+        RSI = 6,
+        RDI = 7,
+        R12 = 12,
+        R13 = 13,
+    };
+
+    enum XmmReg : uint8_t {
+        XMM0 = 0,
+        XMM1 = 1,
+    };
+
+    // x86 condition codes, as used by jcc and setcc.
+    enum Condition : uint8_t {
+        Overflow = 0x0,
+        AboveOrEqual = 0x3,
+        Equal = 0x4,
+        NotEqual = 0x5,
+        Above = 0x7,
+        Parity = 0xA,
+        Less = 0xC,
+        GreaterOrEqual = 0xD,
+        LessOrEqual = 0xE,
+        Greater = 0xF,
+    };
+
+    // A jump target. Jumps to a label that isn't bound yet are patched once it is.
+    class Label final {
+    public:
+        bool isBound() const { return m_offset >= 0; }
+
+    private:
+        friend class Assembler;
+
+        int64_t m_offset{-1};
+        Vector<size_t> m_uses;
+    };
+
+    // Just the instructions the templates need, always in their 32 bit displacement forms so every template has a
+    // fixed shape.
+    class Assembler final {
+    public:
+        const Vector<uint8_t> &code() const { return m_code; }
+
+        void bind(Label &label) {
+            label.m_offset = static_cast<int64_t>(m_code.size());
+            for (const size_t use : label.m_uses) {
+                patchRelative(use, label.m_offset);
+            }
+            label.m_uses.clear();
+        }
+
+        void push(Reg reg) {
+            if (reg >= 8) {
+                emit8(0x41);
+            }
+            emit8(0x50 | (reg & 7));
+        }
+
+        void pop(Reg reg) {
+            if (reg >= 8) {
+                emit8(0x41);
+            }
+            emit8(0x58 | (reg & 7));
+        }
+
+        void ret() { emit8(0xC3); }
+
+        // mov dst, [base + displacement]
+        void load(Reg dst, Reg base, int32_t displacement) {
+            rex(true, dst, base);
+            emit8(0x8B);
+            memoryOperand(dst, base, displacement);
+        }
+
+        // mov [base + displacement], src
+        void store(Reg base, int32_t displacement, Reg src) {
+            rex(true, src, base);
+            emit8(0x89);
+            memoryOperand(src, base, displacement);
+        }
+
+        // lea dst, [base + displacement]
+        void leaAddress(Reg dst, Reg base, int32_t displacement) {
+            rex(true, dst, base);
+            emit8(0x8D);
+            memoryOperand(dst, base, displacement);
+        }
+
+        void move(Reg dst, Reg src) {
+            rex(true, src, dst);
+            emit8(0x89);
+            registerOperand(src, dst);
+        }
+
+        void moveImmediate(Reg dst, uint64_t immediate) {
+            rex(true, 0, dst);
+            emit8(0xB8 | (dst & 7));
+            emit64(immediate);
+        }
+
+        void shiftRight(Reg reg, uint8_t amount) {
+            rex(true, 0, reg);
+            emit8(0xC1);
+            registerOperand(5, reg);
+            emit8(amount);
+        }
+
+        void compareImmediate32(Reg reg, int32_t immediate) {
+            rex(false, 0, reg);
+            emit8(0x81);
+            registerOperand(7, reg);
+            emit32(static_cast<uint32_t>(immediate));
+        }
+
+        void compare64(Reg left, Reg right) { arithmetic(true, 0x39, left, right); }
+
+        void and64(Reg dst, Reg src) { arithmetic(true, 0x21, dst, src); }
+
+        void or64(Reg dst, Reg src) { arithmetic(true, 0x09, dst, src); }
+
+        // The 32 bit forms zero the upper half of dst.
+        void add32(Reg dst, Reg src) { arithmetic(false, 0x01, dst, src); }
+
+        void subtract32(Reg dst, Reg src) { arithmetic(false, 0x29, dst, src); }
+
+        void and32(Reg dst, Reg src) { arithmetic(false, 0x21, dst, src); }
+
+        void or32(Reg dst, Reg src) { arithmetic(false, 0x09, dst, src); }
+
+        void xor32(Reg dst, Reg src) { arithmetic(false, 0x31, dst, src); }
+
+        void compare32(Reg left, Reg right) { arithmetic(false, 0x39, left, right); }
+
+        void test32(Reg left, Reg right) { arithmetic(false, 0x85, left, right); }
+
+        void multiply32(Reg dst, Reg src) {
+            rex(false, dst, src);
+            emit8(0x0F);
+            emit8(0xAF);
+            registerOperand(dst, src);
+        }
+
+        // setcc al; movzx eax, al
+        void setAndZeroExtend(Condition condition) {
+            emit8(0x0F);
+            emit8(0x90 | condition);
+            emit8(0xC0);
+            emit8(0x0F);
+            emit8(0xB6);
+            emit8(0xC0);
+        }
+
+        void testByte() {
+            emit8(0x84); // test al, al
+            emit8(0xC0);
+        }
+
+        void moveToXmm(XmmReg dst, Reg src) {
+            emit8(0x66);
+            rex(true, dst, src);
+            emit8(0x0F);
+            emit8(0x6E);
+            registerOperand(dst, src);
+        }
+
+        void moveFromXmm(Reg dst, XmmReg src) {
+            emit8(0x66);
+            rex(true, src, dst);
+            emit8(0x0F);
+            emit8(0x7E);
+            registerOperand(src, dst);
+        }
+
+        // addsd (0x58), mulsd (0x59), subsd (0x5C) and divsd (0x5E).
+        void scalarDouble(uint8_t opcode, XmmReg dst, XmmReg src) {
+            emit8(0xF2);
+            emit8(0x0F);
+            emit8(opcode);
+            registerOperand(dst, src);
+        }
+
+        void compareUnordered(XmmReg left, XmmReg right) {
+            emit8(0x66);
+            emit8(0x0F);
+            emit8(0x2E);
+            registerOperand(left, right);
+        }
+
+        void adjustStack(int8_t amount) {
+            emit8(0x48);
+            emit8(0x83);
+            emit8(amount < 0 ? 0xEC : 0xC4); // sub rsp / add rsp
+            emit8(static_cast<uint8_t>(amount < 0 ? -amount : amount));
+        }
+
+        void jump(Label &label) {
+            emit8(0xE9);
+            relativeTo(label);
+        }
+
+        void jumpIf(Condition condition, Label &label) {
+            emit8(0x0F);
+            emit8(0x80 | condition);
+            relativeTo(label);
+        }
+
+        // Helpers can be anywhere in the address space, so they are called through rax.
+        void call(const void *function) {
+            moveImmediate(RAX, reinterpret_cast<uint64_t>(function));
+            emit8(0xFF);
+            emit8(0xD0);
+        }
+
+    private:
+        void emit8(uint8_t byte) { m_code.push_back(byte); }
+
+        void emit32(uint32_t value) {
+            for (int i = 0; i < 4; ++i) {
+                emit8(static_cast<uint8_t>(value >> (i * 8)));
+            }
+        }
+
+        void emit64(uint64_t value) {
+            emit32(static_cast<uint32_t>(value));
+            emit32(static_cast<uint32_t>(value >> 32));
+        }
+
+        void rex(bool wide, uint8_t reg, uint8_t rm) {
+            const uint8_t prefix = 0x40 | (wide ? 0x08 : 0) | ((reg >> 3) << 2) | (rm >> 3);
+            if (prefix != 0x40) {
+                emit8(prefix);
+            }
+        }
+
+        void registerOperand(uint8_t reg, uint8_t rm) {
+            emit8(0xC0 | ((reg & 7) << 3) | (rm & 7));
+        }
+
+        // [base + disp32], rsp and r12 as base need a SIB byte.
+        void memoryOperand(uint8_t reg, uint8_t base, int32_t displacement) {
+            emit8(0x80 | ((reg & 7) << 3) | (base & 7));
+            if ((base & 7) == RSP) {
+                emit8(0x24);
+            }
+            emit32(static_cast<uint32_t>(displacement));
+        }
+
+        void arithmetic(bool wide, uint8_t opcode, Reg dst, Reg src) {
+            rex(wide, src, dst);
+            emit8(opcode);
+            registerOperand(src, dst);
+        }
+
+        void relativeTo(Label &label) {
+            const size_t use = m_code.size();
+            emit32(0);
+            if (label.isBound()) {
+                patchRelative(use, label.m_offset);
+            } else {
+                label.m_uses.push_back(use);
+            }
+        }
+
+        void patchRelative(size_t use, int64_t target) {
+            const auto relative = static_cast<int32_t>(target - static_cast<int64_t>(use + 4));
+            std::memcpy(&m_code[use], &relative, sizeof(relative));
+        }
+
+        Vector<uint8_t> m_code;
+    };
+
+    // Runtime helpers the generated code calls, plain functions so their calling convention is the C one.
+    void safepoint(Interpreter *interpreter) {
+        interpreter->safepoint();
+    }
+
+    bool toBoolean(const Value *value) {
+        return value->toBoolean();
+    }
+
+    bool call(Interpreter *interpreter, Value *registers, const Instruction *instruction) {
+        return VM::call(*interpreter, registers, *instruction);
+    }
+
+    bool tailCall(Interpreter *interpreter, Value *registers, const Instruction *instruction) {
+        return VM::tailCall(*interpreter, registers, *instruction);
+    }
+
+    // Register usage of the generated code: rbx holds the frame's registers, r12 the interpreter and r13 the
+    // executable, all callee saved. rax, rcx, rdx, rsi, rdi, xmm0 and xmm1 are scratch.
+    class Compiler final {
+    public:
+        explicit Compiler(const Executable &executable)
+                : m_executable{executable},
+                  m_labels(executable.instructions.size() + 1) {}
+
+        Vector<uint8_t> compile() {
+            emitPrologue();
+            const auto &instructions = m_executable.instructions;
+            for (size_t pc = 0; pc < instructions.size(); ++pc) {
+                m_assembler.bind(m_labels[pc]);
+                compileInstruction(instructions[pc]);
+            }
+            m_assembler.bind(m_labels.back());
+            returnUndefined();
+            m_assembler.bind(m_epilogue);
+            emitEpilogue();
+            return m_assembler.code();
+        }
+
+    private:
+        static int32_t offsetOf(Register reg) {
+            return static_cast<int32_t>(reg * sizeof(Value));
+        }
+
+        void emitPrologue() {
+            m_assembler.push(RBP);
+            m_assembler.move(RBP, RSP);
+            m_assembler.push(RBX);
+            m_assembler.push(R12);
+            m_assembler.push(R13);
+            m_assembler.adjustStack(-8); // Keeps the stack 16 byte aligned for helper calls
+            m_assembler.move(RBX, RDI);
+            m_assembler.move(R12, RSI);
+            m_assembler.move(R13, RDX);
+        }
+
+        void emitEpilogue() {
+            m_assembler.adjustStack(8);
+            m_assembler.pop(R13);
+            m_assembler.pop(R12);
+            m_assembler.pop(RBX);
+            m_assembler.pop(RBP);
+            m_assembler.ret();
+        }
+
+        void returnUndefined() {
+            m_assembler.moveImmediate(RAX, Value().encoded());
+            m_assembler.jump(m_epilogue);
+        }
+
+        // handler(interpreter, executable, registers, instruction)
+        void callHandler(const Instruction &instruction) {
+            m_assembler.move(RDI, R12);
+            m_assembler.move(RSI, R13);
+            m_assembler.move(RDX, RBX);
+            m_assembler.moveImmediate(RCX, reinterpret_cast<uint64_t>(&instruction));
+            m_assembler.call(reinterpret_cast<const void *>(VM::instructionHandler(instruction.opcode)));
+        }
+
+        // helper(interpreter, registers, instruction), returning whether the interpreter is unwinding.
+        void callUnwindingHelper(const void *helper, const Instruction &instruction) {
+            m_assembler.move(RDI, R12);
+            m_assembler.move(RSI, RBX);
+            m_assembler.moveImmediate(RDX, reinterpret_cast<uint64_t>(&instruction));
+            m_assembler.call(helper);
+        }
+
+        void compileInstruction(const Instruction &instruction) {
+            switch (instruction.opcode) {
+                case OpCode::LoadConstant:
+                    // Constants are immortal or rooted by the executable, so their bits can be baked into the code.
+                    m_assembler.moveImmediate(RAX, m_executable.constants[instruction.b].encoded());
+                    m_assembler.store(RBX, offsetOf(instruction.a), RAX);
+                    break;
+                case OpCode::Move:
+                    m_assembler.load(RAX, RBX, offsetOf(instruction.b));
+                    m_assembler.store(RBX, offsetOf(instruction.a), RAX);
+                    break;
+                case OpCode::Jump:
+                    m_assembler.move(RDI, R12);
+                    m_assembler.call(reinterpret_cast<const void *>(&safepoint));
+                    m_assembler.jump(m_labels[instruction.target()]);
+                    break;
+                case OpCode::JumpIfFalse:
+                    compileJumpIfFalse(instruction);
+                    break;
+                case OpCode::Call: {
+                    // Calls go through the same helper and FunctionDeclaration::call as in the VM, pushing the frame
+                    // and entering the callee cost what they cost there. Call heavy code like fib only gains on the
+                    // instructions between its calls.
+                    Label next;
+                    callUnwindingHelper(reinterpret_cast<const void *>(&call), instruction);
+                    m_assembler.testByte();
+                    m_assembler.jumpIf(Equal, next);
+                    returnUndefined();
+                    m_assembler.bind(next);
+                    break;
+                }
+                case OpCode::TailCall:
+                    callUnwindingHelper(reinterpret_cast<const void *>(&tailCall), instruction);
+                    returnUndefined();
+                    break;
+                case OpCode::Return:
+                    m_assembler.load(RAX, RBX, offsetOf(instruction.a));
+                    m_assembler.jump(m_epilogue);
+                    break;
+                case OpCode::End:
+                    returnUndefined();
+                    break;
+                default:
+                    // Compare and branch superinstructions store their result for the JumpIfFalse following them,
+                    // which is compiled on its own.
+                    if (hasBinaryOperator(instruction.opcode)) {
+                        compileBinary(instruction);
+                    } else {
+                        callHandler(instruction);
+                    }
+                    break;
+            }
+        }
+
+        void compileJumpIfFalse(const Instruction &instruction) {
+            Label next;
+            Label &target = m_labels[instruction.target()];
+            m_assembler.load(RAX, RBX, offsetOf(instruction.a));
+            m_assembler.moveImmediate(RDX, Value(false).encoded());
+            m_assembler.compare64(RAX, RDX);
+            m_assembler.jumpIf(Equal, target);
+            m_assembler.moveImmediate(RDX, Value(true).encoded());
+            m_assembler.compare64(RAX, RDX);
+            m_assembler.jumpIf(Equal, next);
+            m_assembler.leaAddress(RDI, RBX, offsetOf(instruction.a));
+            m_assembler.call(reinterpret_cast<const void *>(&toBoolean));
+            m_assembler.testByte();
+            m_assembler.jumpIf(Equal, target);
+            m_assembler.bind(next);
+        }
+
+        void branchIfNotInt32(Reg reg, Label &label) {
+            m_assembler.move(RDX, reg);
+            m_assembler.shiftRight(RDX, 48);
+            m_assembler.compareImmediate32(RDX, Value::int32Tag());
+            m_assembler.jumpIf(NotEqual, label);
+        }
+
+        // Canonical NaN and every tagged Value are all ones under the mask, the canonical NaN just takes the slow path.
+        void branchIfNotDouble(Reg reg, Label &label) {
+            m_assembler.move(RSI, reg);
+            m_assembler.and64(RSI, RDX);
+            m_assembler.compare64(RSI, RDX);
+            m_assembler.jumpIf(Equal, label);
+        }
+
+        void storeTagged(uint64_t tagBits, Register dst) {
+            m_assembler.moveImmediate(RDX, tagBits);
+            m_assembler.or64(RAX, RDX);
+            m_assembler.store(RBX, offsetOf(dst), RAX);
+        }
+
+        // Returns false if the operator has no inline int32 path.
+        bool compileInt32(BinaryOperator op, const Instruction &instruction, Label &slow) {
+            const uint64_t int32Bits = static_cast<uint64_t>(Value::int32Tag()) << 48;
+            const uint64_t booleanBits = static_cast<uint64_t>(Value::booleanTag()) << 48;
+            switch (op) {
+                case BinaryOperator::Add:
+                    m_assembler.add32(RAX, RCX);
+                    m_assembler.jumpIf(Overflow, slow);
+                    break;
+                case BinaryOperator::Subtract:
+                    m_assembler.subtract32(RAX, RCX);
+                    m_assembler.jumpIf(Overflow, slow);
+                    break;
+                case BinaryOperator::Multiply:
+                    // A zero product may have to be -0, that is left to the slow path.
+                    m_assembler.multiply32(RAX, RCX);
+                    m_assembler.jumpIf(Overflow, slow);
+                    m_assembler.test32(RAX, RAX);
+                    m_assembler.jumpIf(Equal, slow);
+                    break;
+                case BinaryOperator::BitwiseAnd:
+                    m_assembler.and32(RAX, RCX);
+                    break;
+                case BinaryOperator::BitwiseOr:
+                    m_assembler.or32(RAX, RCX);
+                    break;
+                case BinaryOperator::BitwiseXor:
+                    m_assembler.xor32(RAX, RCX);
+                    break;
+                case BinaryOperator::Equal:
+                case BinaryOperator::NotEqual:
+                case BinaryOperator::GreaterThanOrEqual:
+                case BinaryOperator::GreaterThan:
+                case BinaryOperator::LessThan:
+                case BinaryOperator::LessThanOrEqual: {
+                    static constexpr Condition conditions[] = {Equal, NotEqual, GreaterOrEqual, Greater, Less,
+                                                               LessOrEqual};
+                    m_assembler.compare32(RAX, RCX);
+                    m_assembler.setAndZeroExtend(
+                            conditions[static_cast<size_t>(op) - static_cast<size_t>(BinaryOperator::Equal)]);
+                    storeTagged(booleanBits, instruction.a);
+                    return true;
+                }
+                default:
+                    return false;
+            }
+            storeTagged(int32Bits, instruction.a);
+            return true;
+        }
+
+        // Returns false if the operator has no inline double path. Equality is left out, NaN makes it branchy.
+        bool compileDouble(BinaryOperator op, const Instruction &instruction, Label &slow) {
+            uint8_t arithmetic = 0;
+            switch (op) {
+                case BinaryOperator::Add:
+                    arithmetic = 0x58;
+                    break;
+                case BinaryOperator::Multiply:
+                    arithmetic = 0x59;
+                    break;
+                case BinaryOperator::Subtract:
+                    arithmetic = 0x5C;
+                    break;
+                case BinaryOperator::Divide:
+                    arithmetic = 0x5E;
+                    break;
+                case BinaryOperator::GreaterThanOrEqual:
+                case BinaryOperator::GreaterThan:
+                case BinaryOperator::LessThan:
+                case BinaryOperator::LessThanOrEqual:
+                    break;
+                default:
+                    return false;
+            }
+
+            m_assembler.moveImmediate(RDX, Value::nanBoxMask());
+            branchIfNotDouble(RAX, slow);
+            branchIfNotDouble(RCX, slow);
+            m_assembler.moveToXmm(XMM0, RAX);
+            m_assembler.moveToXmm(XMM1, RCX);
+            if (arithmetic) {
+                // A NaN result would have to be canonicalized, which the slow path does.
+                m_assembler.scalarDouble(arithmetic, XMM0, XMM1);
+                m_assembler.compareUnordered(XMM0, XMM0);
+                m_assembler.jumpIf(Parity, slow);
+                m_assembler.moveFromXmm(RAX, XMM0);
+                m_assembler.store(RBX, offsetOf(instruction.a), RAX);
+                return true;
+            }
+            // Unordered compares set CF, so above and above-or-equal are false for NaN operands as required.
+            if (op == BinaryOperator::GreaterThanOrEqual || op == BinaryOperator::GreaterThan) {
+                m_assembler.compareUnordered(XMM0, XMM1);
+            } else {
+                m_assembler.compareUnordered(XMM1, XMM0);
+            }
+            const bool orEqual = op == BinaryOperator::GreaterThanOrEqual || op == BinaryOperator::LessThanOrEqual;
+            m_assembler.setAndZeroExtend(orEqual ? AboveOrEqual : Above);
+            storeTagged(static_cast<uint64_t>(Value::booleanTag()) << 48, instruction.a);
+            return true;
+        }
+
+        void compileBinary(const Instruction &instruction) {
+            const BinaryOperator op = binaryOperatorOf(instruction.opcode);
+            Label done;
+            Label notInt32;
+            Label slow;
+            m_assembler.load(RAX, RBX, offsetOf(instruction.b));
+            if (hasConstantOperand(instruction.opcode)) {
+                m_assembler.moveImmediate(RCX, m_executable.constants[instruction.c].encoded());
+            } else {
+                m_assembler.load(RCX, RBX, offsetOf(instruction.c));
+            }
+            branchIfNotInt32(RAX, notInt32);
+            branchIfNotInt32(RCX, notInt32);
+            if (compileInt32(op, instruction, slow)) {
+                m_assembler.jump(done);
+            } else {
+                m_assembler.jump(slow);
+            }
+            m_assembler.bind(notInt32);
+            if (compileDouble(op, instruction, slow)) {
+                m_assembler.jump(done);
+            }
+            m_assembler.bind(slow);
+            callHandler(instruction);
+            m_assembler.bind(done);
+        }
+
+        const Executable &m_executable;
+        Assembler m_assembler;
+        // One label per instruction and one behind the last, the targets of bytecode jumps.
+        Vector<Label> m_labels;
+        Label m_epilogue;
+    };
+
+#endif
+
+}
+
+bool LibJS::JIT::isSupported() {
+    return LIBJS_JIT_SUPPORTED;
+}
+
+LibJS::JIT::Code::Code(void *memory, size_t size)
+        : m_memory{memory},
+          m_size{size} {}
+
+LibJS::JIT::Code::Code(Code &&other) noexcept
+        : m_memory{std::exchange(other.m_memory, nullptr)},
+          m_size{std::exchange(other.m_size, 0)} {}
+
+LibJS::JIT::Code &LibJS::JIT::Code::operator=(Code &&other) noexcept {
+    std::swap(m_memory, other.m_memory);
+    std::swap(m_size, other.m_size);
+    return *this;
+}
+
+LibJS::JIT::Code::~Code() {
+#if LIBJS_JIT_SUPPORTED
+    if (m_memory) {
+        munmap(m_memory, m_size);
+    }
+#endif
+}
+
+LibJS::Value LibJS::JIT::Code::run(Interpreter &interpreter, const Bytecode::Executable &executable) const {
+    const auto entry = reinterpret_cast<Entry>(m_memory);
+    return Value::fromEncoded(entry(interpreter.currentStackFrame().registers(), &interpreter, &executable));
+}
+
+LibJS::Optional<LibJS::JIT::Code> LibJS::JIT::compile(const Bytecode::Executable &executable) {
+#if LIBJS_JIT_SUPPORTED
+    const Vector<uint8_t> code = Compiler(executable).compile();
+    // Written first and only then made executable, the mapping is never writable and executable at the same time.
+    void *memory = mmap(nullptr, code.size(), PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (memory == MAP_FAILED) {
+        return {};
+    }
+    std::memcpy(memory, code.data(), code.size());
+    if (mprotect(memory, code.size(), PROT_READ | PROT_EXEC) != 0) {
+        munmap(memory, code.size());
+        return {};
+    }
+    return Code(memory, code.size());
+#else
+    return {};
+#endif
+}
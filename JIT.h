@@ -0,0 +1,56 @@
+//
+// Baseline template JIT translating the bytecode of hot functions into x86-64 machine code.
+//
+
+#pragma once
+
+#include "Types.h"
+#include "Value.h"
+#include "Bytecode.h"
+
+namespace LibJS {
+    class Interpreter;
+}
+
+namespace LibJS::JIT {
+
+    // Calls a function needs before its bytecode is compiled. Functions that only run a few times aren't worth the
+    // compile time.
+    constexpr uint32_t HotnessThreshold = 32;
+
+    // Whether the JIT can generate code for the CPU and OS it was built for, Linux x86-64 only.
+    bool isSupported();
+
+    // Machine code for one Bytecode::Executable, mapped executable for as long as the object lives. The code runs in
+    // the same stack frame and with the same registers the VM would use, so both can call each other freely.
+    class Code final {
+    public:
+        Code(void *memory, size_t size);
+
+        Code(Code &&other) noexcept;
+
+        Code(const Code &) = delete;
+
+        Code &operator=(const Code &) = delete;
+
+        Code &operator=(Code &&other) noexcept;
+
+        ~Code();
+
+        // Runs in the interpreter's current stack frame, like Bytecode::VM::run.
+        Value run(Interpreter &interpreter, const Bytecode::Executable &executable) const;
+
+    private:
+        using Entry = uint64_t (*)(Value *registers, Interpreter *interpreter, const Bytecode::Executable *executable);
+
+        void *m_memory;
+        size_t m_size;
+    };
+
+    // Every instruction becomes a fixed template. Moves, constants, conditional jumps on booleans and the int32 and
+    // double cases of the common arithmetic and comparison operators are inlined, everything else calls back into
+    // the VM's implementation of the opcode. Returns nothing if the JIT isn't supported or mapping the code failed,
+    // the function then keeps running in the VM.
+    Optional<Code> compile(const Bytecode::Executable &executable);
+
+}
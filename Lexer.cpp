@@ -0,0 +1,419 @@
+//
+// Tokenizer for the JavaScript subset the AST supports. Tokens are views into the source buffer, nothing is copied.
+//
+
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include "Lexer.h"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace {
+
+    enum CharacterClass : uint8_t {
+        Whitespace = 1 << 0,
+        IdentifierStart = 1 << 1,
+        Digit = 1 << 2,
+    };
+
+    // One table lookup instead of a chain of range checks, the character tests run for every byte of the source.
+    constexpr std::array<uint8_t, 256> makeCharacterClasses() {
+        std::array<uint8_t, 256> classes{};
+        for (const char c : {' ', '\t', '\n', '\r', '\v', '\f'}) {
+            classes[static_cast<uint8_t>(c)] = Whitespace;
+        }
+        for (int32_t c = 'a'; c <= 'z'; ++c) {
+            classes[c] = IdentifierStart;
+            classes[c - 'a' + 'A'] = IdentifierStart;
+        }
+        classes['_'] = IdentifierStart;
+        classes['$'] = IdentifierStart;
+        for (int32_t c = '0'; c <= '9'; ++c) {
+            classes[c] = Digit;
+        }
+        return classes;
+    }
+
+    constexpr std::array<uint8_t, 256> s_characterClasses = makeCharacterClasses();
+
+    bool hasClass(char c, uint8_t characterClass) {
+        return s_characterClasses[static_cast<uint8_t>(c)] & characterClass;
+    }
+
+    bool isWhitespace(char c) {
+        return hasClass(c, Whitespace);
+    }
+
+    bool isIdentifierStart(char c) {
+        return hasClass(c, IdentifierStart);
+    }
+
+    bool isIdentifierPart(char c) {
+        return hasClass(c, IdentifierStart | Digit);
+    }
+
+    bool isDigit(char c) {
+        return hasClass(c, Digit);
+    }
+
+#if defined(__SSE2__)
+    constexpr size_t VectorSize = 16;
+
+    // Bytes checked one by one before switching to the vector loop, short runs are cheaper that way.
+    constexpr size_t ScalarPrefix = 8;
+
+    // Bit i is set if byte i of the block is one of the whitespace characters.
+    uint32_t whitespaceMask(__m128i block) {
+        const __m128i space = _mm_cmpeq_epi8(block, _mm_set1_epi8(' '));
+        const __m128i newline = _mm_cmpeq_epi8(block, _mm_set1_epi8('\n'));
+        // '\t', '\n', '\v', '\f' and '\r' are the contiguous range 0x09 - 0x0d.
+        const __m128i control = _mm_and_si128(_mm_cmpgt_epi8(block, _mm_set1_epi8(0x08)),
+                                              _mm_cmplt_epi8(block, _mm_set1_epi8(0x0e)));
+        return _mm_movemask_epi8(_mm_or_si128(_mm_or_si128(space, newline), control));
+    }
+
+    __m128i inRange(__m128i block, char low, char high) {
+        return _mm_and_si128(_mm_cmpgt_epi8(block, _mm_set1_epi8(static_cast<char>(low - 1))),
+                             _mm_cmplt_epi8(block, _mm_set1_epi8(static_cast<char>(high + 1))));
+    }
+
+    // Bit i is set if byte i of the block can continue an identifier.
+    uint32_t identifierPartMask(__m128i block) {
+        const __m128i lowercase = _mm_or_si128(block, _mm_set1_epi8(0x20));
+        const __m128i letter = inRange(lowercase, 'a', 'z');
+        const __m128i digit = inRange(block, '0', '9');
+        const __m128i underscore = _mm_cmpeq_epi8(block, _mm_set1_epi8('_'));
+        const __m128i dollar = _mm_cmpeq_epi8(block, _mm_set1_epi8('$'));
+        return _mm_movemask_epi8(_mm_or_si128(_mm_or_si128(letter, digit), _mm_or_si128(underscore, dollar)));
+    }
+
+    uint32_t equalMask(__m128i block, char c) {
+        return _mm_movemask_epi8(_mm_cmpeq_epi8(block, _mm_set1_epi8(c)));
+    }
+
+    __m128i load(const char *data) {
+        return _mm_loadu_si128(reinterpret_cast<const __m128i *>(data));
+    }
+#endif
+
+}
+
+size_t LibJS::Lexer::skipWhitespace(size_t position) const {
+    const char *data = m_source.data();
+    const size_t size = m_source.size();
+#if defined(__SSE2__)
+    // Most runs are a single space between tokens, only longer ones like indentation pay off in the vector loop.
+    for (const size_t scalarEnd = std::min(position + ScalarPrefix, size); position < scalarEnd; ++position) {
+        if (!isWhitespace(data[position])) {
+            return position;
+        }
+    }
+    while (position + VectorSize <= size) {
+        const uint32_t other = ~whitespaceMask(load(data + position)) & 0xFFFF;
+        if (other) {
+            return position + __builtin_ctz(other);
+        }
+        position += VectorSize;
+    }
+#endif
+    while (position < size && isWhitespace(data[position])) {
+        ++position;
+    }
+    return position;
+}
+
+size_t LibJS::Lexer::skipLineComment(size_t position) const {
+    const char *data = m_source.data();
+    const size_t size = m_source.size();
+#if defined(__SSE2__)
+    while (position + VectorSize <= size) {
+        const uint32_t newline = equalMask(load(data + position), '\n');
+        if (newline) {
+            return position + __builtin_ctz(newline);
+        }
+        position += VectorSize;
+    }
+#endif
+    while (position < size && data[position] != '\n') {
+        ++position;
+    }
+    return position;
+}
+
+// Returns the position after the closing "*/", or npos if the comment isn't terminated.
+size_t LibJS::Lexer::skipBlockComment(size_t position) const {
+    const char *data = m_source.data();
+    const size_t size = m_source.size();
+#if defined(__SSE2__)
+    while (position + VectorSize <= size) {
+        uint32_t stars = equalMask(load(data + position), '*');
+        while (stars) {
+            const size_t star = position + __builtin_ctz(stars);
+            if (star + 1 < size && data[star + 1] == '/') {
+                return star + 2;
+            }
+            stars &= stars - 1;
+        }
+        position += VectorSize;
+    }
+#endif
+    for (; position + 1 < size; ++position) {
+        if (data[position] == '*' && data[position + 1] == '/') {
+            return position + 2;
+        }
+    }
+    return std::string_view::npos;
+}
+
+size_t LibJS::Lexer::scanIdentifier(size_t position) const {
+    const char *data = m_source.data();
+    const size_t size = m_source.size();
+#if defined(__SSE2__)
+    for (const size_t scalarEnd = std::min(position + ScalarPrefix, size); position < scalarEnd; ++position) {
+        if (!isIdentifierPart(data[position])) {
+            return position;
+        }
+    }
+    while (position + VectorSize <= size) {
+        const uint32_t other = ~identifierPartMask(load(data + position)) & 0xFFFF;
+        if (other) {
+            return position + __builtin_ctz(other);
+        }
+        position += VectorSize;
+    }
+#endif
+    while (position < size && isIdentifierPart(data[position])) {
+        ++position;
+    }
+    return position;
+}
+
+void LibJS::Lexer::skipWhitespaceAndComments() {
+    for (;;) {
+        m_position = skipWhitespace(m_position);
+        if (m_position + 1 >= m_source.size() || m_source[m_position] != '/') {
+            return;
+        }
+        if (m_source[m_position + 1] == '/') {
+            m_position = skipLineComment(m_position + 2);
+        } else if (m_source[m_position + 1] == '*') {
+            const size_t end = skipBlockComment(m_position + 2);
+            if (end == std::string_view::npos) {
+                return; // next() reports the unterminated comment
+            }
+            m_position = end;
+        } else {
+            return;
+        }
+    }
+}
+
+LibJS::Token LibJS::Lexer::lexNumber(size_t start) {
+    size_t position = start;
+    const size_t size = m_source.size();
+    if (m_source[position] == '0' && position + 1 < size && (m_source[position + 1] | 0x20) == 'x') {
+        position += 2;
+        while (position < size && std::isxdigit(static_cast<unsigned char>(m_source[position]))) {
+            ++position;
+        }
+        return makeToken(TokenType::NumericLiteral, start, position - start);
+    }
+    while (position < size && isDigit(m_source[position])) {
+        ++position;
+    }
+    if (position < size && m_source[position] == '.') {
+        ++position;
+        while (position < size && isDigit(m_source[position])) {
+            ++position;
+        }
+    }
+    if (position < size && (m_source[position] | 0x20) == 'e') {
+        size_t exponent = position + 1;
+        if (exponent < size && (m_source[exponent] == '+' || m_source[exponent] == '-')) {
+            ++exponent;
+        }
+        if (exponent < size && isDigit(m_source[exponent])) {
+            position = exponent;
+            while (position < size && isDigit(m_source[position])) {
+                ++position;
+            }
+        }
+    }
+    if (position < size && isIdentifierStart(m_source[position])) {
+        return makeToken(TokenType::Invalid, start, position + 1 - start);
+    }
+    return makeToken(TokenType::NumericLiteral, start, position - start);
+}
+
+LibJS::Token LibJS::Lexer::lexString(size_t start) {
+    const char quote = m_source[start];
+    const char *data = m_source.data();
+    const size_t size = m_source.size();
+    size_t position = start + 1;
+    for (;;) {
+#if defined(__SSE2__)
+        while (position + VectorSize <= size) {
+            const __m128i block = load(data + position);
+            const uint32_t special = equalMask(block, quote) | equalMask(block, '\\') | equalMask(block, '\n');
+            if (special) {
+                position += __builtin_ctz(special);
+                break;
+            }
+            position += VectorSize;
+        }
+#endif
+        while (position < size && data[position] != quote && data[position] != '\\' && data[position] != '\n') {
+            ++position;
+        }
+        if (position >= size || data[position] == '\n') {
+            return makeToken(TokenType::Invalid, start, position - start);
+        }
+        if (data[position] == quote) {
+            return makeToken(TokenType::StringLiteral, start, position + 1 - start);
+        }
+        position += 2; // Skip the escaped character, the parser decodes escapes
+    }
+}
+
+LibJS::Token LibJS::Lexer::next() {
+    skipWhitespaceAndComments();
+
+    const size_t start = m_position;
+    const size_t size = m_source.size();
+    if (start >= size) {
+        return Token{TokenType::Eof, m_source.substr(size)};
+    }
+
+    const char c = m_source[start];
+    if (isIdentifierStart(c)) {
+        const size_t end = scanIdentifier(start + 1);
+        Token token = makeToken(TokenType::Identifier, start, end - start);
+        const std::string_view value = token.value;
+        switch (value.size()) {
+            case 2:
+                if (value == "if") token.type = TokenType::If;
+                break;
+            case 3:
+                if (value == "var") token.type = TokenType::Var;
+                else if (value == "let") token.type = TokenType::Let;
+                else if (value == "for") token.type = TokenType::For;
+                else if (value == "try") token.type = TokenType::Try;
+                break;
+            case 4:
+                if (value == "else") token.type = TokenType::Else;
+                else if (value == "true") token.type = TokenType::True;
+                else if (value == "null") token.type = TokenType::Null;
+                break;
+            case 5:
+                if (value == "const") token.type = TokenType::Const;
+                else if (value == "false") token.type = TokenType::False;
+                else if (value == "while") token.type = TokenType::While;
+                else if (value == "break") token.type = TokenType::Break;
+                else if (value == "catch") token.type = TokenType::Catch;
+                else if (value == "throw") token.type = TokenType::Throw;
+                break;
+            case 6:
+                if (value == "return") token.type = TokenType::Return;
+                break;
+            case 7:
+                if (value == "finally") token.type = TokenType::Finally;
+                break;
+            case 8:
+                if (value == "function") token.type = TokenType::Function;
+                else if (value == "continue") token.type = TokenType::Continue;
+                break;
+            default:
+                break;
+        }
+        return token;
+    }
+
+    if (isDigit(c) || (c == '.' && start + 1 < size && isDigit(m_source[start + 1]))) {
+        return lexNumber(start);
+    }
+
+    if (c == '"' || c == '\'') {
+        return lexString(start);
+    }
+
+    auto peek = [&](size_t offset) -> char {
+        return start + offset < size ? m_source[start + offset] : '\0';
+    };
+
+    switch (c) {
+        case '(':
+            return makeToken(TokenType::LeftParen, start, 1);
+        case ')':
+            return makeToken(TokenType::RightParen, start, 1);
+        case '{':
+            return makeToken(TokenType::LeftBrace, start, 1);
+        case '}':
+            return makeToken(TokenType::RightBrace, start, 1);
+        case ',':
+            return makeToken(TokenType::Comma, start, 1);
+        case ';':
+            return makeToken(TokenType::Semicolon, start, 1);
+        case ':':
+            return makeToken(TokenType::Colon, start, 1);
+        case '.':
+            return makeToken(TokenType::Period, start, 1);
+        case '+':
+            if (peek(1) == '+') return makeToken(TokenType::PlusPlus, start, 2);
+            if (peek(1) == '=') return makeToken(TokenType::PlusEquals, start, 2);
+            return makeToken(TokenType::Plus, start, 1);
+        case '-':
+            if (peek(1) == '-') return makeToken(TokenType::MinusMinus, start, 2);
+            if (peek(1) == '=') return makeToken(TokenType::MinusEquals, start, 2);
+            return makeToken(TokenType::Minus, start, 1);
+        case '*':
+            if (peek(1) == '*') return makeToken(TokenType::DoubleAsterisk, start, 2);
+            if (peek(1) == '=') return makeToken(TokenType::AsteriskEquals, start, 2);
+            return makeToken(TokenType::Asterisk, start, 1);
+        case '/':
+            if (peek(1) == '*') return makeToken(TokenType::Invalid, start, size - start); // Unterminated comment
+            if (peek(1) == '=') return makeToken(TokenType::SlashEquals, start, 2);
+            return makeToken(TokenType::Slash, start, 1);
+        case '%':
+            return makeToken(TokenType::Percent, start, 1);
+        case '&':
+            return makeToken(TokenType::Ampersand, start, 1);
+        case '|':
+            return makeToken(TokenType::Pipe, start, 1);
+        case '^':
+            return makeToken(TokenType::Caret, start, 1);
+        case '<':
+            if (peek(1) == '<') return makeToken(TokenType::ShiftLeft, start, 2);
+            if (peek(1) == '=') return makeToken(TokenType::LessThanEquals, start, 2);
+            return makeToken(TokenType::LessThan, start, 1);
+        case '>':
+            if (peek(1) == '>') return makeToken(TokenType::ShiftRight, start, 2);
+            if (peek(1) == '=') return makeToken(TokenType::GreaterThanEquals, start, 2);
+            return makeToken(TokenType::GreaterThan, start, 1);
+        case '=':
+            if (peek(1) == '=' && peek(2) == '=') return makeToken(TokenType::EqualsEqualsEquals, start, 3);
+            if (peek(1) == '=') return makeToken(TokenType::EqualsEquals, start, 2);
+            return makeToken(TokenType::Equals, start, 1);
+        case '!':
+            if (peek(1) == '=' && peek(2) == '=') return makeToken(TokenType::ExclamationMarkEqualsEquals, start, 3);
+            if (peek(1) == '=') return makeToken(TokenType::ExclamationMarkEquals, start, 2);
+            return makeToken(TokenType::ExclamationMark, start, 1);
+        default:
+            return makeToken(TokenType::Invalid, start, 1);
+    }
+}
+
+LibJS::String LibJS::Lexer::positionOf(const Token &token) const {
+    const size_t offset = token.value.data() - m_source.data();
+    size_t line = 1;
+    size_t lineStart = 0;
+    for (size_t i = 0; i < offset; ++i) {
+        if (m_source[i] == '\n') {
+            ++line;
+            lineStart = i + 1;
+        }
+    }
+    return std::to_string(line) + ":" + std::to_string(offset - lineStart + 1);
+}
@@ -0,0 +1,120 @@
+//
+// Tokenizer for the JavaScript subset the AST supports. Tokens are views into the source buffer, nothing is copied.
+//
+
+#pragma once
+
+#include <string_view>
+#include "Types.h"
+
+namespace LibJS {
+
+    enum class TokenType {
+        Eof,
+        Invalid,
+
+        Identifier,
+        NumericLiteral,
+        StringLiteral,
+
+        // Keywords
+        Break,
+        Catch,
+        Const,
+        Continue,
+        Else,
+        False,
+        Finally,
+        For,
+        Function,
+        If,
+        Let,
+        Null,
+        Return,
+        Throw,
+        True,
+        Try,
+        Var,
+        While,
+
+        // Punctuators
+        LeftParen,
+        RightParen,
+        LeftBrace,
+        RightBrace,
+        Comma,
+        Semicolon,
+        Colon,
+        Period,
+        Plus,
+        PlusPlus,
+        PlusEquals,
+        Minus,
+        MinusMinus,
+        MinusEquals,
+        Asterisk,
+        DoubleAsterisk,
+        AsteriskEquals,
+        Slash,
+        SlashEquals,
+        Percent,
+        Ampersand,
+        Pipe,
+        Caret,
+        ShiftLeft,
+        ShiftRight,
+        Equals,
+        EqualsEquals,
+        EqualsEqualsEquals,
+        ExclamationMark,
+        ExclamationMarkEquals,
+        ExclamationMarkEqualsEquals,
+        LessThan,
+        LessThanEquals,
+        GreaterThan,
+        GreaterThanEquals,
+    };
+
+    struct Token {
+        TokenType type{TokenType::Eof};
+        // Slice of the source. String literals include their quotes, Invalid tokens hold the offending text.
+        std::string_view value;
+    };
+
+    class Lexer final {
+    public:
+        explicit Lexer(std::string_view source)
+                : m_source{source} {}
+
+        Token next();
+
+        std::string_view source() const { return m_source; }
+
+        // 1-based "line:column" of a token, only computed when an error has to be reported.
+        String positionOf(const Token &token) const;
+
+    private:
+        void skipWhitespaceAndComments();
+
+        size_t skipWhitespace(size_t position) const;
+
+        size_t skipLineComment(size_t position) const;
+
+        size_t skipBlockComment(size_t position) const;
+
+        size_t scanIdentifier(size_t position) const;
+
+        Token lexNumber(size_t start);
+
+        Token lexString(size_t start);
+
+        Token makeToken(TokenType type, size_t start, size_t length) {
+            m_position = start + length;
+            return Token{type, m_source.substr(start, length)};
+        }
+
+        std::string_view m_source;
+        size_t m_position{0};
+    };
+
+}
@@ -0,0 +1,113 @@
+//
+// Logging by category and level. Levels below LIBJS_LOG_LEVEL are compiled out, messages that are compiled in are
+// buffered and only written in large chunks.
+//
+
+#include <array>
+#include <cstdio>
+#include <sstream>
+#include "Log.h"
+
+namespace {
+
+    using LibJS::Log::Category;
+    using LibJS::Log::Level;
+
+    // Messages are collected in memory and written to stderr once this many bytes are buffered.
+    constexpr std::streamoff BufferSize = 64 * 1024;
+
+    const char *categoryName(Category category) {
+        switch (category) {
+            case Category::Interpreter:
+                return "interpreter";
+            case Category::Heap:
+                return "heap";
+            case Category::Bytecode:
+                return "bytecode";
+            case Category::JIT:
+                return "jit";
+        }
+        return "unknown";
+    }
+
+    const char *levelName(Level level) {
+        switch (level) {
+            case Level::Trace:
+                return "trace";
+            case Level::Debug:
+                return "debug";
+            case Level::Info:
+                return "info";
+            case Level::Warning:
+                return "warning";
+            case Level::Error:
+                return "error";
+            case Level::Off:
+                break;
+        }
+        return "unknown";
+    }
+
+    // Like the rest of the runtime the logger isn't thread safe.
+    struct Logger {
+        std::ostringstream buffer;
+        Level level{LibJS::Log::CompiledLevel};
+        std::array<bool, LibJS::Log::CategoryCount> enabled{};
+
+        Logger() {
+            enabled.fill(true);
+        }
+
+        // Whatever is still buffered at exit is written then.
+        ~Logger() {
+            flush();
+        }
+
+        void flush() {
+            const LibJS::String text = buffer.str();
+            if (text.empty()) {
+                return;
+            }
+            std::fwrite(text.data(), 1, text.size(), stderr);
+            std::fflush(stderr);
+            buffer.str({});
+        }
+    };
+
+    Logger &logger() {
+        static Logger s_logger;
+        return s_logger;
+    }
+
+}
+
+void LibJS::Log::setCategoryEnabled(Category category, bool enabled) {
+    logger().enabled[static_cast<int32_t>(category)] = enabled;
+}
+
+void LibJS::Log::setLevel(Level level) {
+    logger().level = level;
+}
+
+bool LibJS::Log::isEnabled(Category category, Level level) {
+    const Logger &instance = logger();
+    return isCompiledIn(level) && level >= instance.level && instance.enabled[static_cast<int32_t>(category)];
+}
+
+std::ostream &LibJS::Log::beginMessage(Category category, Level level) {
+    auto &buffer = logger().buffer;
+    buffer << '[' << categoryName(category) << "] " << levelName(level) << ": ";
+    return buffer;
+}
+
+void LibJS::Log::endMessage() {
+    Logger &instance = logger();
+    instance.buffer << '\n';
+    if (instance.buffer.tellp() >= BufferSize) {
+        instance.flush();
+    }
+}
+
+void LibJS::Log::flush() {
+    logger().flush();
+}
@@ -0,0 +1,96 @@
+//
+// Logging by category and level. Levels below LIBJS_LOG_LEVEL are compiled out, messages that are compiled in are
+// buffered and only written in large chunks.
+//
+
+#pragma once
+
+#include <ostream>
+#include "Types.h"
+
+// The lowest level compiled in, the index of a Log::Level. The LIBJS_LOG_LEVEL CMake option sets it, without it
+// nothing is logged.
+#ifndef LIBJS_LOG_LEVEL
+#define LIBJS_LOG_LEVEL 5
+#endif
+
+namespace LibJS::Log {
+
+    enum class Level : uint8_t {
+        Trace,
+        Debug,
+        Info,
+        Warning,
+        Error,
+        Off
+    };
+
+    enum class Category : uint8_t {
+        Interpreter,
+        Heap,
+        Bytecode,
+        JIT
+    };
+
+    static constexpr int32_t CategoryCount = static_cast<int32_t>(Category::JIT) + 1;
+
+    static constexpr Level CompiledLevel = static_cast<Level>(LIBJS_LOG_LEVEL);
+
+    constexpr bool isCompiledIn(Level level) {
+        return level >= CompiledLevel && level != Level::Off;
+    }
+
+    // Everything that is compiled in is logged unless its category is turned off or the level raised at runtime.
+    void setCategoryEnabled(Category category, bool enabled);
+
+    void setLevel(Level level);
+
+    bool isEnabled(Category category, Level level);
+
+    // The stream the message is formatted into, the message ends with the next endMessage().
+    std::ostream &beginMessage(Category category, Level level);
+
+    void endMessage();
+
+    // Writes the buffered messages, which otherwise happens when the buffer is full and at exit.
+    void flush();
+
+    // `message` is called with the stream to write the message to, so formatting it costs nothing when the message
+    // isn't logged, and the whole call is gone when its level isn't compiled in:
+    //     Log::debug(Log::Category::Heap, [&](std::ostream &out) { out << count << " cells freed"; });
+    template<Level level, typename Message>
+    void log(Category category, Message &&message) {
+        if constexpr (isCompiledIn(level)) {
+            if (isEnabled(category, level)) {
+                message(beginMessage(category, level));
+                endMessage();
+            }
+        }
+    }
+
+    template<typename Message>
+    void trace(Category category, Message &&message) {
+        log<Level::Trace>(category, std::forward<Message>(message));
+    }
+
+    template<typename Message>
+    void debug(Category category, Message &&message) {
+        log<Level::Debug>(category, std::forward<Message>(message));
+    }
+
+    template<typename Message>
+    void info(Category category, Message &&message) {
+        log<Level::Info>(category, std::forward<Message>(message));
+    }
+
+    template<typename Message>
+    void warning(Category category, Message &&message) {
+        log<Level::Warning>(category, std::forward<Message>(message));
+    }
+
+    template<typename Message>
+    void error(Category category, Message &&message) {
+        log<Level::Error>(category, std::forward<Message>(message));
+    }
+
+}
@@ -0,0 +1,222 @@
+//
+// Table driven implementation of the binary operators.
+//
+
+#include <cctype>
+#include <charconv>
+#include <cmath>
+#include <cstdlib>
+#include <limits>
+#include <utility>
+#include "Operators.h"
+
+namespace {
+
+    using LibJS::BinaryOperator;
+    using LibJS::Value;
+    using LibJS::compareOrder;
+    using LibJS::doubleOperation;
+    using LibJS::int32Operation;
+    using Type = LibJS::Value::Type;
+
+    // Below this length copying the characters is cheaper than allocating a rope node and flattening it later.
+    constexpr size_t MinimumRopeLength = 64;
+
+    LibJS::PrimitiveString *toPrimitiveString(const Value &value) {
+        if (value.isString()) {
+            return value.asPrimitiveString();
+        }
+        return LibJS::Heap::current().allocate<LibJS::PrimitiveString>(value.toString());
+    }
+
+    Value concatenate(LibJS::PrimitiveString *left, LibJS::PrimitiveString *right) {
+        if (right->length() == 0) {
+            return Value(left);
+        }
+        if (left->length() == 0) {
+            return Value(right);
+        }
+        if (left->length() + right->length() < MinimumRopeLength) {
+            return Value(left->string() + right->string());
+        }
+        return Value(LibJS::Heap::current().allocate<LibJS::PrimitiveString>(left, right));
+    }
+
+    bool isStringWhitespace(char c) {
+        return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\v' || c == '\f';
+    }
+
+    double stringToNumber(std::string_view string) {
+        while (!string.empty() && isStringWhitespace(string.front())) {
+            string.remove_prefix(1);
+        }
+        while (!string.empty() && isStringWhitespace(string.back())) {
+            string.remove_suffix(1);
+        }
+        if (string.empty()) {
+            return 0;
+        }
+
+        if (string.size() > 2 && string[0] == '0' && (string[1] | 0x20) == 'x') {
+            uint64_t integer = 0;
+            const auto result = std::from_chars(string.data() + 2, string.data() + string.size(), integer, 16);
+            return result.ec == std::errc() && result.ptr == string.data() + string.size()
+                   ? static_cast<double>(integer) : NAN;
+        }
+
+        const bool negative = string.front() == '-';
+        std::string_view unsigned_ = string;
+        if (string.front() == '+' || negative) {
+            unsigned_.remove_prefix(1);
+        }
+        if (unsigned_ == "Infinity") {
+            return negative ? -INFINITY : INFINITY;
+        }
+        // from_chars would accept "inf" and "nan", which aren't numbers in JavaScript.
+        if (unsigned_.empty() || !(std::isdigit(static_cast<unsigned char>(unsigned_.front())) ||
+                                   unsigned_.front() == '.')) {
+            return NAN;
+        }
+        double number = 0;
+        const auto result = LibJS::doubleFromChars(unsigned_.data(), unsigned_.data() + unsigned_.size(), number);
+        if (result.ptr != unsigned_.data() + unsigned_.size() ||
+            (result.ec != std::errc() && result.ec != std::errc::result_out_of_range)) {
+            return NAN;
+        }
+        return negative ? -number : number;
+    }
+
+    constexpr bool isRelational(BinaryOperator op) {
+        return op == BinaryOperator::GreaterThanOrEqual || op == BinaryOperator::GreaterThan ||
+               op == BinaryOperator::LessThan || op == BinaryOperator::LessThanOrEqual;
+    }
+
+    constexpr bool isEquality(BinaryOperator op) {
+        return op == BinaryOperator::Equal || op == BinaryOperator::NotEqual;
+    }
+
+    // Types whose ToNumber doesn't need to look at anything but the Value itself.
+    constexpr bool hasPrimitiveNumber(Type type) {
+        return type == Type::Int || type == Type::Number || type == Type::Boolean || type == Type::Null ||
+               type == Type::Undefined;
+    }
+
+    // Objects and functions convert to their string form when mixed with strings or added to anything.
+    constexpr bool convertsToString(Type type) {
+        return type == Type::String || type == Type::Object || type == Type::Function;
+    }
+
+    template<Type type>
+    double toNumberOf(const Value &value) {
+        if constexpr (type == Type::Int) {
+            return value.asInt32();
+        } else if constexpr (type == Type::Number) {
+            return value.asDouble();
+        } else if constexpr (type == Type::Boolean) {
+            return value.asBool() ? 1 : 0;
+        } else if constexpr (type == Type::Null) {
+            return 0;
+        } else if constexpr (type == Type::String) {
+            return stringToNumber(value.asString());
+        } else {
+            return NAN;
+        }
+    }
+
+    // Abstract equality (==) for operands of different or non numeric types.
+    template<Type left, Type right>
+    bool looselyEquals(const Value &a, const Value &b) {
+        if constexpr (left == right) {
+            if constexpr (left == Type::String) {
+                return a.asPrimitiveString() == b.asPrimitiveString() || a.asString() == b.asString();
+            } else if constexpr (left == Type::BigInt) {
+                return a.asBigInt()->toString() == b.asBigInt()->toString();
+            } else if constexpr (left == Type::Undefined || left == Type::Null) {
+                return true;
+            } else {
+                return a.encoded() == b.encoded();
+            }
+        } else if constexpr ((left == Type::Undefined || left == Type::Null) &&
+                             (right == Type::Undefined || right == Type::Null)) {
+            return true;
+        } else if constexpr (left == Type::Undefined || left == Type::Null || right == Type::Undefined ||
+                             right == Type::Null) {
+            return false;
+        } else if constexpr (convertsToString(left) && convertsToString(right)) {
+            return a.toString() == b.toString();
+        } else if constexpr (left == Type::Object || left == Type::Function || right == Type::Object ||
+                             right == Type::Function || left == Type::BigInt || right == Type::BigInt) {
+            // Their string forms never convert to a number equal to anything.
+            return false;
+        } else {
+            return toNumberOf<left>(a) == toNumberOf<right>(b);
+        }
+    }
+
+    template<BinaryOperator op, Type left, Type right>
+    Value kernel(const Value &a, const Value &b) {
+        if constexpr (left == Type::Int && right == Type::Int) {
+            return int32Operation<op>(a.asInt32(), b.asInt32());
+        } else if constexpr (op == BinaryOperator::Add && (convertsToString(left) || convertsToString(right))) {
+            return concatenate(toPrimitiveString(a), toPrimitiveString(b));
+        } else if constexpr (isEquality(op) && !(hasPrimitiveNumber(left) && hasPrimitiveNumber(right) &&
+                                                 left != Type::Undefined && right != Type::Undefined &&
+                                                 left != Type::Null && right != Type::Null)) {
+            const bool equal = looselyEquals<left, right>(a, b);
+            return Value(op == BinaryOperator::Equal ? equal : !equal);
+        } else if constexpr (isRelational(op) && left == Type::String && right == Type::String) {
+            return compareOrder<op>(a.asString().compare(b.asString()));
+        } else {
+            return doubleOperation<op>(toNumberOf<left>(a), toNumberOf<right>(b));
+        }
+    }
+
+    constexpr size_t KernelCount = LibJS::BinaryOperatorCount * LibJS::ValueTypeCount * LibJS::ValueTypeCount;
+
+    template<size_t index>
+    constexpr LibJS::BinaryKernel kernelAt() {
+        constexpr auto op = static_cast<BinaryOperator>(index / (LibJS::ValueTypeCount * LibJS::ValueTypeCount));
+        constexpr auto left = static_cast<Type>(index / LibJS::ValueTypeCount % LibJS::ValueTypeCount);
+        constexpr auto right = static_cast<Type>(index % LibJS::ValueTypeCount);
+        return &kernel<op, left, right>;
+    }
+
+    template<size_t... indices>
+    constexpr std::array<LibJS::BinaryKernel, KernelCount> makeKernels(std::index_sequence<indices...>) {
+        return {kernelAt<indices>()...};
+    }
+
+}
+
+constexpr std::array<LibJS::BinaryKernel, KernelCount> LibJS::g_binaryKernels =
+        makeKernels(std::make_index_sequence<KernelCount>());
+
+double LibJS::toNumber(const Value &value) {
+    switch (value.type()) {
+        case Type::Int:
+            return toNumberOf<Type::Int>(value);
+        case Type::Number:
+            return toNumberOf<Type::Number>(value);
+        case Type::Boolean:
+            return toNumberOf<Type::Boolean>(value);
+        case Type::Null:
+            return toNumberOf<Type::Null>(value);
+        case Type::String:
+            return toNumberOf<Type::String>(value);
+        default:
+            return NAN;
+    }
+}
+
+std::from_chars_result LibJS::doubleFromChars(const char *begin, const char *end, double &value,
+                                              std::chars_format format) {
+    const auto result = std::from_chars(begin, end, value, format);
+    if (result.ec == std::errc::result_out_of_range) {
+        // from_chars doesn't say in which direction, strtod does and rounds to the nearest denormal as well. This is
+        // the rare path, copying the digits to terminate them is fine.
+        String digits(format == std::chars_format::hex ? "0x" : "");
+        digits.append(begin, result.ptr);
+        value = std::strtod(digits.c_str(), nullptr);
+    }
+    return result;
+}
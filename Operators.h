@@ -0,0 +1,193 @@
+//
+// Table driven implementation of the binary operators. Every (operator, left type, right type) combination gets its
+// own kernel, generated at compile time, so evaluating an operator is a single indexed call.
+//
+
+#pragma once
+
+#include <array>
+#include <charconv>
+#include <cmath>
+#include <limits>
+#include "Types.h"
+#include "Value.h"
+
+namespace LibJS {
+
+    enum class BinaryOperator : uint8_t {
+        Add,
+        Subtract,
+        Divide,
+        Multiply,
+        Modulo,
+        Power,
+        BitwiseAnd,
+        BitwiseOr,
+        BitwiseXor,
+        LeftShift,
+        RightShift,
+        Equal,
+        NotEqual,
+        GreaterThanOrEqual,
+        GreaterThan,
+        LessThan,
+        LessThanOrEqual
+    };
+
+    constexpr size_t BinaryOperatorCount = static_cast<size_t>(BinaryOperator::LessThanOrEqual) + 1;
+
+    constexpr size_t ValueTypeCount = static_cast<size_t>(Value::Type::Function) + 1;
+
+    constexpr bool isBitwiseOperator(BinaryOperator op) {
+        return op == BinaryOperator::BitwiseAnd || op == BinaryOperator::BitwiseOr ||
+               op == BinaryOperator::BitwiseXor || op == BinaryOperator::LeftShift ||
+               op == BinaryOperator::RightShift;
+    }
+
+    // ToInt32 of the spec, wraps modulo 2^32.
+    inline int32_t toInt32(double number) {
+        if (!std::isfinite(number)) {
+            return 0;
+        }
+        const double truncated = std::trunc(number);
+        const double wrapped = std::fmod(truncated, 4294967296.0);
+        const auto bits = static_cast<uint32_t>(static_cast<int64_t>(wrapped < 0 ? wrapped + 4294967296.0 : wrapped));
+        return static_cast<int32_t>(bits);
+    }
+
+    // Exponentiation differs from std::pow for a NaN exponent and for +-1 ** +-Infinity, which are NaN.
+    inline double exponentiate(double base, double exponent) {
+        if (std::isnan(exponent)) {
+            return NAN;
+        }
+        if (std::isinf(exponent) && std::fabs(base) == 1) {
+            return NAN;
+        }
+        return std::pow(base, exponent);
+    }
+
+    template<BinaryOperator op>
+    Value compareOrder(int order) {
+        if constexpr (op == BinaryOperator::GreaterThanOrEqual) {
+            return Value(order >= 0);
+        } else if constexpr (op == BinaryOperator::GreaterThan) {
+            return Value(order > 0);
+        } else if constexpr (op == BinaryOperator::LessThan) {
+            return Value(order < 0);
+        } else {
+            return Value(order <= 0);
+        }
+    }
+
+    template<BinaryOperator op>
+    Value int32Operation(int32_t left, int32_t right);
+
+    // The kernels for two numbers, shared by the table and by nodes that specialized on numeric operands.
+    template<BinaryOperator op>
+    Value doubleOperation(double left, double right) {
+        if constexpr (op == BinaryOperator::Add) {
+            return Value(left + right);
+        } else if constexpr (op == BinaryOperator::Subtract) {
+            return Value(left - right);
+        } else if constexpr (op == BinaryOperator::Divide) {
+            return Value(left / right);
+        } else if constexpr (op == BinaryOperator::Multiply) {
+            return Value(left * right);
+        } else if constexpr (op == BinaryOperator::Modulo) {
+            return Value(std::fmod(left, right));
+        } else if constexpr (op == BinaryOperator::Power) {
+            return Value(exponentiate(left, right));
+        } else if constexpr (isBitwiseOperator(op)) {
+            return int32Operation<op>(toInt32(left), toInt32(right));
+        } else if constexpr (op == BinaryOperator::Equal) {
+            return Value(left == right);
+        } else if constexpr (op == BinaryOperator::NotEqual) {
+            return Value(left != right);
+        } else if constexpr (op == BinaryOperator::GreaterThanOrEqual) {
+            return Value(left >= right);
+        } else if constexpr (op == BinaryOperator::GreaterThan) {
+            return Value(left > right);
+        } else if constexpr (op == BinaryOperator::LessThan) {
+            return Value(left < right);
+        } else {
+            return Value(left <= right);
+        }
+    }
+
+    // Int results stay Int, everything that overflows or needs a fraction or -0 is promoted to a Number.
+    template<BinaryOperator op>
+    Value int32Operation(int32_t left, int32_t right) {
+        int32_t result;
+        if constexpr (op == BinaryOperator::Add) {
+            if (__builtin_add_overflow(left, right, &result)) {
+                return Value(static_cast<double>(left) + right);
+            }
+            return Value(result);
+        } else if constexpr (op == BinaryOperator::Subtract) {
+            if (__builtin_sub_overflow(left, right, &result)) {
+                return Value(static_cast<double>(left) - right);
+            }
+            return Value(result);
+        } else if constexpr (op == BinaryOperator::Multiply) {
+            if (__builtin_mul_overflow(left, right, &result)) {
+                return Value(static_cast<double>(left) * right);
+            }
+            if (result == 0 && (left < 0 || right < 0)) {
+                return Value(-0.0);
+            }
+            return Value(result);
+        } else if constexpr (op == BinaryOperator::Divide) {
+            if (right == 0 || (left == 0 && right < 0) || (left == std::numeric_limits<int32_t>::min() && right == -1) ||
+                left % right != 0) {
+                return Value(static_cast<double>(left) / right);
+            }
+            return Value(left / right);
+        } else if constexpr (op == BinaryOperator::Modulo) {
+            if (right == 0) {
+                return Value(NAN);
+            }
+            result = right == -1 ? 0 : left % right;
+            if (result == 0 && left < 0) {
+                return Value(-0.0);
+            }
+            return Value(result);
+        } else if constexpr (op == BinaryOperator::Power) {
+            return Value(exponentiate(left, right));
+        } else if constexpr (op == BinaryOperator::BitwiseAnd) {
+            return Value(left & right);
+        } else if constexpr (op == BinaryOperator::BitwiseOr) {
+            return Value(left | right);
+        } else if constexpr (op == BinaryOperator::BitwiseXor) {
+            return Value(left ^ right);
+        } else if constexpr (op == BinaryOperator::LeftShift) {
+            return Value(static_cast<int32_t>(static_cast<uint32_t>(left) << (right & 31)));
+        } else if constexpr (op == BinaryOperator::RightShift) {
+            return Value(left >> (right & 31));
+        } else if constexpr (op == BinaryOperator::Equal) {
+            return Value(left == right);
+        } else if constexpr (op == BinaryOperator::NotEqual) {
+            return Value(left != right);
+        } else {
+            return compareOrder<op>(left < right ? -1 : left > right ? 1 : 0);
+        }
+    }
+
+    using BinaryKernel = Value (*)(const Value &left, const Value &right);
+
+    extern const std::array<BinaryKernel, BinaryOperatorCount * ValueTypeCount * ValueTypeCount> g_binaryKernels;
+
+    inline Value binaryOperation(BinaryOperator op, const Value &left, const Value &right) {
+        const size_t index = (static_cast<size_t>(op) * ValueTypeCount + static_cast<size_t>(left.type())) *
+                             ValueTypeCount + static_cast<size_t>(right.type());
+        return g_binaryKernels[index](left, right);
+    }
+
+    // ToNumber of the spec, BigInts, objects and functions become NaN.
+    double toNumber(const Value &value);
+
+    // std::from_chars for doubles without a sign, except that a result out of range is Infinity if it overflows and 0
+    // or a denormal if it underflows, instead of leaving `value` unchanged. Hex digits come without their 0x prefix.
+    std::from_chars_result doubleFromChars(const char *begin, const char *end, double &value,
+                                           std::chars_format format = std::chars_format::general);
+
+}
@@ -0,0 +1,621 @@
+//
+// Recursive descent parser building the AST.h nodes from JavaScript source.
+//
+
+#include <charconv>
+#include <utility>
+#include "Parser.h"
+
+namespace {
+
+    using LibJS::BinaryExpression;
+    using LibJS::TokenType;
+
+    // Higher binds tighter, -1 if the token isn't a binary operator.
+    int32_t binaryPrecedence(TokenType type) {
+        switch (type) {
+            case TokenType::Pipe:
+                return 1;
+            case TokenType::Caret:
+                return 2;
+            case TokenType::Ampersand:
+                return 3;
+            case TokenType::EqualsEquals:
+            case TokenType::ExclamationMarkEquals:
+                return 4;
+            case TokenType::LessThan:
+            case TokenType::LessThanEquals:
+            case TokenType::GreaterThan:
+            case TokenType::GreaterThanEquals:
+                return 5;
+            case TokenType::ShiftLeft:
+            case TokenType::ShiftRight:
+                return 6;
+            case TokenType::Plus:
+            case TokenType::Minus:
+                return 7;
+            case TokenType::Asterisk:
+            case TokenType::Slash:
+            case TokenType::Percent:
+                return 8;
+            case TokenType::DoubleAsterisk:
+                return 9;
+            default:
+                return -1;
+        }
+    }
+
+    BinaryExpression::BinaryOperator binaryOperator(TokenType type) {
+        switch (type) {
+            case TokenType::Pipe:
+                return BinaryExpression::BinaryOperator::BitwiseOr;
+            case TokenType::Caret:
+                return BinaryExpression::BinaryOperator::BitwiseXor;
+            case TokenType::Ampersand:
+                return BinaryExpression::BinaryOperator::BitwiseAnd;
+            case TokenType::EqualsEquals:
+                return BinaryExpression::BinaryOperator::Equal;
+            case TokenType::ExclamationMarkEquals:
+                return BinaryExpression::BinaryOperator::NotEqual;
+            case TokenType::LessThan:
+                return BinaryExpression::BinaryOperator::LessThan;
+            case TokenType::LessThanEquals:
+                return BinaryExpression::BinaryOperator::LessThanOrEqual;
+            case TokenType::GreaterThan:
+                return BinaryExpression::BinaryOperator::GreaterThan;
+            case TokenType::GreaterThanEquals:
+                return BinaryExpression::BinaryOperator::GreaterThanOrEqual;
+            case TokenType::ShiftLeft:
+                return BinaryExpression::BinaryOperator::LeftShift;
+            case TokenType::ShiftRight:
+                return BinaryExpression::BinaryOperator::RightShift;
+            case TokenType::Plus:
+                return BinaryExpression::BinaryOperator::Add;
+            case TokenType::Minus:
+                return BinaryExpression::BinaryOperator::Subtract;
+            case TokenType::Asterisk:
+                return BinaryExpression::BinaryOperator::Multiply;
+            case TokenType::Slash:
+                return BinaryExpression::BinaryOperator::Divide;
+            case TokenType::Percent:
+                return BinaryExpression::BinaryOperator::Modulo;
+            default:
+                return BinaryExpression::BinaryOperator::Power;
+        }
+    }
+
+    void appendUtf8(LibJS::String &string, uint32_t codePoint) {
+        if (codePoint < 0x80) {
+            string += static_cast<char>(codePoint);
+        } else if (codePoint < 0x800) {
+            string += static_cast<char>(0xC0 | (codePoint >> 6));
+            string += static_cast<char>(0x80 | (codePoint & 0x3F));
+        } else {
+            string += static_cast<char>(0xE0 | (codePoint >> 12));
+            string += static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F));
+            string += static_cast<char>(0x80 | (codePoint & 0x3F));
+        }
+    }
+
+}
+
+LibJS::UniquePtr<LibJS::Program> LibJS::Parser::parseProgram(Program::SourceType type) {
+    auto program = std::make_unique<Program>(type);
+    m_program = program.get();
+    while (!done()) {
+        Statement *statement = parseStatement();
+        if (statement) {
+            program->append(statement);
+        }
+    }
+    m_program = nullptr;
+    return program;
+}
+
+LibJS::Statement *LibJS::Parser::parseStatement() {
+    const NestingScope nesting(*this);
+    switch (m_current.type) {
+        case TokenType::Var:
+        case TokenType::Let:
+        case TokenType::Const: {
+            auto declaration = parseVariableDeclaration();
+            consumeIf(TokenType::Semicolon);
+            return declaration;
+        }
+        case TokenType::Function:
+            return parseFunctionDeclaration();
+        case TokenType::Return:
+            return parseReturnStatement();
+        case TokenType::If:
+            return parseIfStatement();
+        case TokenType::While:
+            return parseWhileStatement();
+        case TokenType::For:
+            return parseForStatement();
+        case TokenType::Break:
+        case TokenType::Continue:
+            return parseJumpStatement();
+        case TokenType::Throw:
+            return parseThrowStatement();
+        case TokenType::Try:
+            return parseTryStatement();
+        case TokenType::LeftBrace:
+            return make<BlockStatement>(parseBlock());
+        case TokenType::Semicolon:
+            consume();
+            return nullptr; // Empty statement
+        default: {
+            auto *statement = make<ExpressionStatement>(parseExpression());
+            consumeIf(TokenType::Semicolon);
+            return statement;
+        }
+    }
+}
+
+LibJS::Span<LibJS::Statement *> LibJS::Parser::parseBlock() {
+    expect(TokenType::LeftBrace, "'{'");
+    Vector<Statement *> body;
+    while (!done() && !match(TokenType::RightBrace)) {
+        Statement *statement = parseStatement();
+        if (statement) {
+            body.push_back(statement);
+        }
+    }
+    expect(TokenType::RightBrace, "'}'");
+    return m_program->makeArray(body);
+}
+
+LibJS::Statement *LibJS::Parser::parseVariableDeclaration() {
+    VariableDeclaration::Kind kind;
+    switch (consume().type) {
+        case TokenType::Var:
+            kind = VariableDeclaration::Kind::Var;
+            break;
+        case TokenType::Let:
+            kind = VariableDeclaration::Kind::Let;
+            break;
+        default:
+            kind = VariableDeclaration::Kind::Const;
+            break;
+    }
+
+    Vector<VariableDeclarator *> declarators;
+    do {
+        const Token name = expect(TokenType::Identifier, "variable name");
+        Expression *init;
+        if (consumeIf(TokenType::Equals)) {
+            init = parseExpression();
+        } else {
+            init = make<Literal>(JsUndefined());
+        }
+        declarators.push_back(make<VariableDeclarator>(makeIdentifier(name.value), init));
+    } while (!done() && consumeIf(TokenType::Comma));
+
+    return make<VariableDeclaration>(kind, m_program->makeArray(declarators));
+}
+
+LibJS::Statement *LibJS::Parser::parseFunctionDeclaration() {
+    consume();
+    const Token name = expect(TokenType::Identifier, "function name");
+    expect(TokenType::LeftParen, "'('");
+    Vector<Identifier *> params;
+    while (!done() && !match(TokenType::RightParen)) {
+        const Token param = expect(TokenType::Identifier, "parameter name");
+        params.push_back(makeIdentifier(param.value));
+        if (!consumeIf(TokenType::Comma)) {
+            break;
+        }
+    }
+    expect(TokenType::RightParen, "')'");
+    // Loops outside of the function aren't targets for break and continue inside of it.
+    const int32_t loopDepth = std::exchange(m_loopDepth, 0);
+    const int32_t tryDepth = std::exchange(m_tryDepth, 0);
+    ++m_functionDepth;
+    auto *body = make<BlockStatement>(parseBlock());
+    --m_functionDepth;
+    m_loopDepth = loopDepth;
+    m_tryDepth = tryDepth;
+    return make<FunctionDeclaration>(makeIdentifier(name.value), m_program->makeArray(params), body);
+}
+
+LibJS::Statement *LibJS::Parser::parseReturnStatement() {
+    if (m_functionDepth == 0) {
+        syntaxError("Illegal return statement");
+    }
+    consume();
+    Expression *argument;
+    if (match(TokenType::Semicolon) || match(TokenType::RightBrace) || match(TokenType::Eof)) {
+        argument = make<Literal>(JsUndefined());
+    } else {
+        argument = parseExpression();
+    }
+    consumeIf(TokenType::Semicolon);
+    return make<ReturnStatement>(argument, m_tryDepth == 0);
+}
+
+LibJS::Statement *LibJS::Parser::parseIfStatement() {
+    consume();
+    expect(TokenType::LeftParen, "'('");
+    Expression *test = parseExpression();
+    expect(TokenType::RightParen, "')'");
+
+    auto parseBranch = [this]() -> Statement *{
+        Statement *statement = parseStatement();
+        if (!statement) {
+            return make<BlockStatement>(Span<Statement *>());
+        }
+        return statement;
+    };
+
+    Statement *consequent = parseBranch();
+    if (!consumeIf(TokenType::Else)) {
+        return make<IfStatement>(test, consequent);
+    }
+    Statement *alternate = parseBranch();
+    return make<IfStatement>(test, consequent, alternate);
+}
+
+LibJS::Statement *LibJS::Parser::parseWhileStatement() {
+    consume();
+    expect(TokenType::LeftParen, "'('");
+    Expression *test = parseExpression();
+    expect(TokenType::RightParen, "')'");
+    return make<WhileStatement>(test, parseLoopBody());
+}
+
+// Only the three part form, for-in and for-of aren't supported.
+LibJS::Statement *LibJS::Parser::parseForStatement() {
+    consume();
+    expect(TokenType::LeftParen, "'('");
+    Statement *init = nullptr;
+    if (match(TokenType::Var) || match(TokenType::Let) || match(TokenType::Const)) {
+        init = parseVariableDeclaration();
+    } else if (!match(TokenType::Semicolon)) {
+        init = make<ExpressionStatement>(parseExpression());
+    }
+    expect(TokenType::Semicolon, "';'");
+    Expression *test = match(TokenType::Semicolon) ? nullptr : parseExpression();
+    expect(TokenType::Semicolon, "';'");
+    Expression *update = match(TokenType::RightParen) ? nullptr : parseExpression();
+    expect(TokenType::RightParen, "')'");
+    return make<ForStatement>(init, test, update, parseLoopBody());
+}
+
+LibJS::Statement *LibJS::Parser::parseLoopBody() {
+    ++m_loopDepth;
+    Statement *body = parseStatement();
+    --m_loopDepth;
+    return body ? body : make<BlockStatement>(Span<Statement *>());
+}
+
+// Labels aren't supported, break and continue always refer to the innermost loop.
+LibJS::Statement *LibJS::Parser::parseJumpStatement() {
+    const bool isBreak = consume().type == TokenType::Break;
+    if (m_loopDepth == 0) {
+        syntaxError(isBreak ? "Illegal break statement" : "Illegal continue statement");
+    }
+    consumeIf(TokenType::Semicolon);
+    if (isBreak) {
+        return make<BreakStatement>();
+    }
+    return make<ContinueStatement>();
+}
+
+LibJS::Statement *LibJS::Parser::parseThrowStatement() {
+    consume();
+    Expression *argument = parseExpression();
+    consumeIf(TokenType::Semicolon);
+    return make<ThrowStatement>(argument);
+}
+
+// Returns anywhere in a try statement aren't tail calls, the statement still has work to do once they complete.
+LibJS::Statement *LibJS::Parser::parseTryStatement() {
+    consume();
+    ++m_tryDepth;
+    auto *block = make<BlockStatement>(parseBlock());
+    Identifier *parameter = nullptr;
+    BlockStatement *handler = nullptr;
+    if (consumeIf(TokenType::Catch)) {
+        if (consumeIf(TokenType::LeftParen)) {
+            parameter = makeIdentifier(expect(TokenType::Identifier, "catch parameter").value);
+            expect(TokenType::RightParen, "')'");
+        }
+        handler = make<BlockStatement>(parseBlock());
+    }
+    BlockStatement *finalizer = nullptr;
+    if (consumeIf(TokenType::Finally)) {
+        finalizer = make<BlockStatement>(parseBlock());
+    }
+    --m_tryDepth;
+    if (!handler && !finalizer) {
+        syntaxError("Missing catch or finally after try");
+    }
+    return make<TryStatement>(block, parameter, handler, finalizer);
+}
+
+LibJS::Expression *LibJS::Parser::parseExpression() {
+    const NestingScope nesting(*this);
+    Expression *left = parseBinaryExpression(0);
+
+    AssignmentExpression::AssignmentOperator op;
+    switch (m_current.type) {
+        case TokenType::Equals:
+            op = AssignmentExpression::AssignmentOperator::Assignment;
+            break;
+        case TokenType::PlusEquals:
+            op = AssignmentExpression::AssignmentOperator::AdditionAssignment;
+            break;
+        case TokenType::MinusEquals:
+            op = AssignmentExpression::AssignmentOperator::SubtractionAssignment;
+            break;
+        case TokenType::AsteriskEquals:
+            op = AssignmentExpression::AssignmentOperator::MultiplicationAssignment;
+            break;
+        case TokenType::SlashEquals:
+            op = AssignmentExpression::AssignmentOperator::DivisionAssignment;
+            break;
+        default:
+            return left;
+    }
+
+    if (!dynamic_cast<Identifier *>(left) && !dynamic_cast<MemberExpression *>(left)) {
+        syntaxError("Invalid assignment target");
+        return left;
+    }
+    consume();
+    Expression *right = parseExpression(); // Assignments are right associative
+    return make<AssignmentExpression>(op, left, right);
+}
+
+// Precedence climbing, ** is the only right associative operator.
+LibJS::Expression *LibJS::Parser::parseBinaryExpression(int32_t minimumPrecedence) {
+    Expression *left = parseUnaryExpression();
+    NestingScope links(*this, 0);
+    for (;;) {
+        const int32_t precedence = binaryPrecedence(m_current.type);
+        if (precedence < 0 || precedence < minimumPrecedence || hasError()) {
+            return left;
+        }
+        const TokenType type = consume().type;
+        links.deepen();
+        const int32_t nextMinimum = type == TokenType::DoubleAsterisk ? precedence : precedence + 1;
+        Expression *right = parseBinaryExpression(nextMinimum);
+        left = make<BinaryExpression>(binaryOperator(type), left, right);
+    }
+}
+
+// There's no UnaryExpression node, negation of anything but a numeric literal is expressed as 0 - operand.
+LibJS::Expression *LibJS::Parser::parseUnaryExpression() {
+    if (match(TokenType::PlusPlus) || match(TokenType::MinusMinus)) {
+        const NestingScope nesting(*this);
+        const TokenType type = consume().type;
+        return parseUpdateExpression(type, parseUnaryExpression(), false);
+    }
+    if (consumeIf(TokenType::Plus)) {
+        const NestingScope nesting(*this);
+        return parseUnaryExpression();
+    }
+    if (!consumeIf(TokenType::Minus)) {
+        Expression *expression = parseCallExpression();
+        if (match(TokenType::PlusPlus) || match(TokenType::MinusMinus)) {
+            return parseUpdateExpression(consume().type, expression, true);
+        }
+        return expression;
+    }
+    if (match(TokenType::NumericLiteral)) {
+        const String negated = "-" + String(consume().value);
+        return parseNumericLiteral(negated);
+    }
+    const NestingScope nesting(*this);
+    return make<BinaryExpression>(BinaryExpression::BinaryOperator::Subtract, make<Literal>(Value(0)),
+                                  parseUnaryExpression());
+}
+
+// Increments and decrements are compound assignments of 1.
+LibJS::Expression *LibJS::Parser::parseUpdateExpression(TokenType type, Expression *target, bool postfix) {
+    if (!dynamic_cast<Identifier *>(target) && !dynamic_cast<MemberExpression *>(target)) {
+        syntaxError("Invalid increment or decrement operand");
+        return target;
+    }
+    const auto op = type == TokenType::PlusPlus ? AssignmentExpression::AssignmentOperator::Increment
+                                                : AssignmentExpression::AssignmentOperator::Decrement;
+    return make<AssignmentExpression>(op, target, make<Literal>(Value(1)), postfix);
+}
+
+LibJS::Expression *LibJS::Parser::parseCallExpression() {
+    Expression *expression = parsePrimaryExpression();
+    NestingScope links(*this, 0);
+    while (!hasError()) {
+        if (consumeIf(TokenType::Period)) {
+            links.deepen();
+            const Token property = expect(TokenType::Identifier, "property name");
+            expression = make<MemberExpression>(expression, Atom::intern(property.value));
+            continue;
+        }
+        if (!consumeIf(TokenType::LeftParen)) {
+            break;
+        }
+        links.deepen();
+        Vector<Expression *> arguments;
+        while (!done() && !match(TokenType::RightParen)) {
+            arguments.push_back(parseExpression());
+            if (!consumeIf(TokenType::Comma)) {
+                break;
+            }
+        }
+        expect(TokenType::RightParen, "')'");
+        expression = make<CallExpression>(expression, m_program->makeArray(arguments));
+    }
+    return expression;
+}
+
+LibJS::Expression *LibJS::Parser::parsePrimaryExpression() {
+    switch (m_current.type) {
+        case TokenType::Identifier:
+            return makeIdentifier(consume().value);
+        case TokenType::NumericLiteral:
+            return parseNumericLiteral(consume().value);
+        case TokenType::StringLiteral:
+            return parseStringLiteral(consume().value);
+        case TokenType::True:
+            consume();
+            return make<Literal>(Value(true));
+        case TokenType::False:
+            consume();
+            return make<Literal>(Value(false));
+        case TokenType::Null:
+            consume();
+            return make<Literal>(Value::null());
+        case TokenType::LeftBrace:
+            return parseObjectExpression();
+        case TokenType::LeftParen: {
+            consume();
+            Expression *expression = parseExpression();
+            expect(TokenType::RightParen, "')'");
+            return expression;
+        }
+        default:
+            syntaxError("Unexpected token '" + String(m_current.value) + "'");
+            return make<Literal>(JsUndefined());
+    }
+}
+
+// Keys are identifiers or string literals, string keys are interned with their decoded contents.
+LibJS::Expression *LibJS::Parser::parseObjectExpression() {
+    consume();
+    Vector<Property *> properties;
+    while (!done() && !match(TokenType::RightBrace)) {
+        Atom key;
+        if (match(TokenType::StringLiteral)) {
+            key = Atom::intern(decodeStringLiteral(consume().value));
+        } else {
+            key = Atom::intern(expect(TokenType::Identifier, "property name").value);
+        }
+        expect(TokenType::Colon, "':'");
+        properties.push_back(make<Property>(key, parseExpression()));
+        if (!consumeIf(TokenType::Comma)) {
+            break;
+        }
+    }
+    expect(TokenType::RightBrace, "'}'");
+    return make<ObjectExpression>(m_program->makeArray(properties));
+}
+
+// Integers that fit are Int values, everything else becomes a Number.
+LibJS::Expression *LibJS::Parser::parseNumericLiteral(std::string_view text) {
+    const bool negative = !text.empty() && text.front() == '-';
+    const std::string_view digits = negative ? text.substr(1) : text;
+    const char *begin = digits.data();
+    const char *end = begin + digits.size();
+
+    int32_t base = 10;
+    if (digits.size() > 2 && digits[0] == '0' && (digits[1] | 0x20) == 'x') {
+        base = 16;
+        begin += 2;
+    }
+
+    if (base == 16 || digits.find_first_of(".eE") == std::string_view::npos) {
+        uint64_t integer = 0;
+        const auto result = std::from_chars(begin, end, integer, base);
+        if (result.ec == std::errc() && result.ptr == end) {
+            if (integer == 0 && negative) {
+                return make<Literal>(Value(-0.0));
+            }
+            const int64_t value = negative ? -static_cast<int64_t>(integer) : static_cast<int64_t>(integer);
+            if (integer <= static_cast<uint64_t>(std::numeric_limits<int32_t>::max()) + 1 &&
+                value >= std::numeric_limits<int32_t>::min() && value <= std::numeric_limits<int32_t>::max()) {
+                return make<Literal>(Value(static_cast<int32_t>(value)));
+            }
+        }
+    }
+
+    double number = 0;
+    const auto format = base == 16 ? std::chars_format::hex : std::chars_format::general;
+    const auto result = doubleFromChars(begin, end, number, format);
+    if (result.ec != std::errc() && result.ec != std::errc::result_out_of_range) {
+        syntaxError("Invalid number '" + String(text) + "'");
+    }
+    return make<Literal>(Value(negative ? -number : number));
+}
+
+LibJS::Expression *LibJS::Parser::parseStringLiteral(std::string_view text) {
+    return make<Literal>(m_program->makeString(decodeStringLiteral(text)));
+}
+
+LibJS::String LibJS::Parser::decodeStringLiteral(std::string_view text) {
+    const std::string_view contents = text.substr(1, text.size() - 2);
+    String string;
+    string.reserve(contents.size());
+    for (size_t i = 0; i < contents.size(); ++i) {
+        const char c = contents[i];
+        if (c != '\\' || i + 1 >= contents.size()) {
+            string += c;
+            continue;
+        }
+        const char escaped = contents[++i];
+        switch (escaped) {
+            case 'n':
+                string += '\n';
+                break;
+            case 't':
+                string += '\t';
+                break;
+            case 'r':
+                string += '\r';
+                break;
+            case 'b':
+                string += '\b';
+                break;
+            case 'f':
+                string += '\f';
+                break;
+            case 'v':
+                string += '\v';
+                break;
+            case '0':
+                string += '\0';
+                break;
+            case 'x':
+            case 'u': {
+                const size_t length = escaped == 'x' ? 2 : 4;
+                uint32_t codePoint = 0;
+                const char *begin = contents.data() + i + 1;
+                const auto result = std::from_chars(begin, begin + std::min(length, contents.size() - i - 1),
+                                                    codePoint, 16);
+                if (result.ptr != begin + length) {
+                    syntaxError("Invalid escape sequence in string literal");
+                    return string;
+                }
+                appendUtf8(string, codePoint);
+                i += length;
+                break;
+            }
+            default:
+                string += escaped;
+                break;
+        }
+    }
+    return string;
+}
+
+LibJS::Token LibJS::Parser::expect(TokenType type, const char *what) {
+    if (!match(type)) {
+        syntaxError("Expected " + String(what) + " but got '" + String(m_current.value) + "'");
+        return m_current;
+    }
+    return consume();
+}
+
+void LibJS::Parser::syntaxError(const String &message) {
+    if (m_error) {
+        return;
+    }
+    if (m_current.type == TokenType::Invalid) {
+        m_error = "Invalid token '" + String(m_current.value.substr(0, 32)) + "' at " + m_lexer.positionOf(m_current);
+    } else if (m_current.type == TokenType::Eof) {
+        m_error = message + " at end of input";
+    } else {
+        m_error = message + " at " + m_lexer.positionOf(m_current);
+    }
+    m_current = Token{TokenType::Eof, m_lexer.source().substr(m_lexer.source().size())};
+}
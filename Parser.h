@@ -0,0 +1,156 @@
+//
+// Recursive descent parser building the AST.h nodes from JavaScript source.
+//
+
+#pragma once
+
+#include "AST.h"
+#include "Lexer.h"
+
+namespace LibJS {
+
+    class Parser final {
+    public:
+        // Statements and expressions nested deeper than this are a syntax error instead of overflowing the native
+        // stack. A level is a statement, an expression, a prefix operator or a link of a chain like `a + b + c` or
+        // `o.a.b`, each a node the passes over the tree recurse into. At this depth they all stay within the
+        // interpreter's NativeStackReserve in debug builds.
+        static constexpr int32_t MaxNestingDepth = 1000;
+
+        explicit Parser(std::string_view source)
+                : m_lexer{source},
+                  m_current{m_lexer.next()} {}
+
+        // Parsing stops at the first error, the returned program then only contains what was parsed before it.
+        UniquePtr<Program> parseProgram(Program::SourceType type = Program::SourceType::Script);
+
+        bool hasError() const { return m_error.has_value(); }
+
+        const String &error() const { return m_error.value(); }
+
+    private:
+        Statement *parseStatement();
+
+        Span<Statement *> parseBlock();
+
+        Statement *parseVariableDeclaration();
+
+        Statement *parseFunctionDeclaration();
+
+        Statement *parseReturnStatement();
+
+        Statement *parseIfStatement();
+
+        Statement *parseWhileStatement();
+
+        Statement *parseForStatement();
+
+        Statement *parseLoopBody();
+
+        Statement *parseJumpStatement();
+
+        Statement *parseThrowStatement();
+
+        Statement *parseTryStatement();
+
+        Expression *parseExpression();
+
+        Expression *parseBinaryExpression(int32_t minimumPrecedence);
+
+        Expression *parseUnaryExpression();
+
+        Expression *parseUpdateExpression(TokenType type, Expression *target, bool postfix);
+
+        Expression *parseCallExpression();
+
+        Expression *parsePrimaryExpression();
+
+        Expression *parseObjectExpression();
+
+        Expression *parseNumericLiteral(std::string_view text);
+
+        Expression *parseStringLiteral(std::string_view text);
+
+        String decodeStringLiteral(std::string_view text);
+
+        // Stays at the end of input once an error was reported, see syntaxError.
+        Token consume() {
+            Token token = m_current;
+            if (!hasError()) {
+                m_current = m_lexer.next();
+            }
+            return token;
+        }
+
+        bool match(TokenType type) const { return m_current.type == type; }
+
+        bool consumeIf(TokenType type) {
+            if (!match(type)) {
+                return false;
+            }
+            consume();
+            return true;
+        }
+
+        Token expect(TokenType type, const char *what);
+
+        // Counts levels of nesting for as long as it lives, chains deepen it once per link.
+        class NestingScope final {
+        public:
+            explicit NestingScope(Parser &parser, int32_t levels = 1)
+                    : m_parser{parser} {
+                for (int32_t i = 0; i < levels; ++i) {
+                    deepen();
+                }
+            }
+
+            NestingScope(const NestingScope &) = delete;
+
+            NestingScope &operator=(const NestingScope &) = delete;
+
+            ~NestingScope() {
+                m_parser.m_nestingDepth -= m_levels;
+            }
+
+            void deepen() {
+                ++m_levels;
+                if (++m_parser.m_nestingDepth > MaxNestingDepth) {
+                    m_parser.syntaxError("Too deeply nested");
+                }
+            }
+
+        private:
+            Parser &m_parser;
+            int32_t m_levels{0};
+        };
+
+        void syntaxError(const String &message);
+
+        bool done() const { return hasError() || match(TokenType::Eof); }
+
+        // Every node is allocated in the arena of the program being parsed.
+        template<typename T, typename... Args>
+        T *make(Args &&... args) {
+            return m_program->make<T>(std::forward<Args>(args)...);
+        }
+
+        Identifier *makeIdentifier(std::string_view name) {
+            return make<Identifier>(Atom::intern(name));
+        }
+
+        Lexer m_lexer;
+        Token m_current;
+        Program *m_program{nullptr};
+        Optional<String> m_error;
+        // Functions enclosing the current position, return needs one.
+        int32_t m_functionDepth{0};
+        // Loops enclosing the current position within the current function, break and continue need one.
+        int32_t m_loopDepth{0};
+        // Try statements enclosing the current position within the current function, returns in them aren't in tail
+        // position.
+        int32_t m_tryDepth{0};
+        // Levels of nesting around the current position, see MaxNestingDepth.
+        int32_t m_nestingDepth{0};
+    };
+
+}
@@ -0,0 +1,67 @@
+//
+// Heap cell holding the characters of a string Value. Concatenations build ropes that are only flattened once the
+// characters are actually needed.
+//
+
+#pragma once
+
+#include "Cell.h"
+
+namespace LibJS {
+
+    class PrimitiveString final : public Cell {
+    public:
+        explicit PrimitiveString(String string)
+                : m_string{std::move(string)},
+                  m_length{m_string.size()} {}
+
+        // Rope node for left + right, nothing is copied until string() is called.
+        PrimitiveString(PrimitiveString *left, PrimitiveString *right)
+                : m_left{left},
+                  m_right{right},
+                  m_length{left->length() + right->length()} {}
+
+        const String &string() const {
+            if (isRope()) {
+                flatten();
+            }
+            return m_string;
+        }
+
+        size_t length() const { return m_length; }
+
+        bool isRope() const { return m_left != nullptr; }
+
+        virtual void visitEdges(Visitor &visitor) override {
+            visitor.visit(m_left);
+            visitor.visit(m_right);
+        }
+
+    private:
+        // Strings built with += in a loop are left leaning ropes as deep as the loop ran, so the tree is walked with
+        // an explicit stack instead of recursion.
+        void flatten() const {
+            m_string.reserve(m_length);
+            Vector<const PrimitiveString *> pending{m_right, m_left};
+            while (!pending.empty()) {
+                const PrimitiveString *node = pending.back();
+                pending.pop_back();
+                if (node->isRope()) {
+                    pending.push_back(node->m_right);
+                    pending.push_back(node->m_left);
+                } else {
+                    m_string += node->m_string;
+                }
+            }
+            // The children may become garbage now.
+            m_left = nullptr;
+            m_right = nullptr;
+        }
+
+        mutable String m_string;
+        mutable PrimitiveString *m_left{nullptr};
+        mutable PrimitiveString *m_right{nullptr};
+        size_t m_length;
+    };
+
+}
@@ -0,0 +1,217 @@
+//
+// Sampling profiler attributing CPU time to the JS call stack, see LibJS --profile.
+//
+
+#include <algorithm>
+#include <iomanip>
+#include <typeinfo>
+#include <unordered_map>
+#include <unordered_set>
+#include "Profiler.h"
+#include "AST.h"
+
+#if defined(__unix__) || defined(__APPLE__)
+#define LIBJS_PROFILER_SUPPORTED 1
+#include <csignal>
+#include <sys/time.h>
+#else
+#define LIBJS_PROFILER_SUPPORTED 0
+#endif
+
+#if defined(__GNUG__)
+#include <cxxabi.h>
+#endif
+
+namespace {
+
+    LibJS::Profiler *g_activeProfiler = nullptr;
+
+#if LIBJS_PROFILER_SUPPORTED
+    struct sigaction g_previousAction;
+#endif
+
+    LibJS::String functionName(const LibJS::FrameLayout *layout) {
+        if (!layout || layout->functionName().isEmpty()) {
+            return "(program)";
+        }
+        return LibJS::String(layout->functionName().string());
+    }
+
+    // The node's class, which is all there is to tell statements apart without source positions.
+    LibJS::String nodeName(const LibJS::ASTNode *node) {
+        LibJS::String name = typeid(*node).name();
+#if defined(__GNUG__)
+        int status = 0;
+        char *demangled = abi::__cxa_demangle(name.c_str(), nullptr, nullptr, &status);
+        if (status == 0) {
+            name = demangled;
+        }
+        std::free(demangled);
+#endif
+        const auto separator = name.rfind("::");
+        return separator != LibJS::String::npos ? name.substr(separator + 2) : name;
+    }
+
+    template<typename T, typename Count>
+    LibJS::Vector<std::pair<LibJS::String, T>> topEntries(const std::map<LibJS::String, T> &entries, int32_t count,
+                                                          Count countOf) {
+        LibJS::Vector<std::pair<LibJS::String, T>> sorted(entries.begin(), entries.end());
+        std::stable_sort(sorted.begin(), sorted.end(), [&](const auto &a, const auto &b) {
+            return countOf(a.second) > countOf(b.second);
+        });
+        if (sorted.size() > static_cast<size_t>(count)) {
+            sorted.resize(count);
+        }
+        return sorted;
+    }
+
+}
+
+LibJS::Profiler::Profiler(Interpreter &interpreter, int32_t intervalMicroseconds)
+        : m_interpreter{interpreter},
+          m_intervalMicroseconds{intervalMicroseconds},
+          m_buffer(BufferCapacity) {
+    assert(intervalMicroseconds > 0);
+}
+
+LibJS::Profiler::~Profiler() {
+    if (m_running) {
+        stop();
+    }
+}
+
+bool LibJS::Profiler::isSupported() {
+    return LIBJS_PROFILER_SUPPORTED;
+}
+
+void LibJS::Profiler::start() {
+#if LIBJS_PROFILER_SUPPORTED
+    if (m_running) {
+        return;
+    }
+    assert(!g_activeProfiler);
+    g_activeProfiler = this;
+    m_running = true;
+
+    struct sigaction action{};
+    action.sa_handler = &Profiler::handleSignal;
+    action.sa_flags = SA_RESTART;
+    sigemptyset(&action.sa_mask);
+    sigaction(SIGPROF, &action, &g_previousAction);
+
+    itimerval timer{};
+    timer.it_interval.tv_sec = m_intervalMicroseconds / 1'000'000;
+    timer.it_interval.tv_usec = m_intervalMicroseconds % 1'000'000;
+    timer.it_value = timer.it_interval;
+    setitimer(ITIMER_PROF, &timer, nullptr);
+#endif
+}
+
+void LibJS::Profiler::stop() {
+#if LIBJS_PROFILER_SUPPORTED
+    if (!m_running) {
+        return;
+    }
+    const itimerval disarmed{};
+    setitimer(ITIMER_PROF, &disarmed, nullptr);
+    sigaction(SIGPROF, &g_previousAction, nullptr);
+    g_activeProfiler = nullptr;
+    m_running = false;
+    aggregate();
+#endif
+}
+
+void LibJS::Profiler::handleSignal(int) {
+    if (g_activeProfiler) {
+        g_activeProfiler->recordSample();
+    }
+}
+
+// Runs in the signal handler: no allocations, no locks, only copies into the buffer.
+void LibJS::Profiler::recordSample() {
+    const auto frames = m_interpreter.stackFrames();
+    const size_t depth = std::min(frames.size(), static_cast<size_t>(MaxDepth));
+    if (m_bufferSize + depth + 2 > m_buffer.size()) {
+        ++m_droppedSampleCount;
+        return;
+    }
+    const ASTNode *node = nullptr;
+#if LIBJS_PROFILE_NODES
+    node = frames.back().executingNode();
+#endif
+    m_buffer[m_bufferSize++] = frames.size();
+    m_buffer[m_bufferSize++] = reinterpret_cast<uintptr_t>(node);
+    for (size_t i = frames.size() - depth; i < frames.size(); ++i) {
+        m_buffer[m_bufferSize++] = reinterpret_cast<uintptr_t>(frames[i].layout());
+    }
+    ++m_sampleCount;
+}
+
+// Recursive functions count once towards the total of a sample, however often they are on its stack.
+void LibJS::Profiler::aggregate() {
+    std::unordered_map<uintptr_t, String> names;
+    std::unordered_set<String> onStack;
+    for (size_t i = 0; i < m_bufferSize;) {
+        const size_t frameCount = m_buffer[i++];
+        const auto *node = reinterpret_cast<const ASTNode *>(m_buffer[i++]);
+        const size_t depth = std::min(frameCount, static_cast<size_t>(MaxDepth));
+        String stack = frameCount > depth ? "(truncated)" : "";
+        const String *innermost = nullptr;
+        onStack.clear();
+        for (size_t j = 0; j < depth; ++j, ++i) {
+            auto found = names.find(m_buffer[i]);
+            if (found == names.end()) {
+                found = names.emplace(m_buffer[i], functionName(reinterpret_cast<const FrameLayout *>(m_buffer[i])))
+                             .first;
+            }
+            const String &name = found->second;
+            if (!stack.empty()) {
+                stack += ';';
+            }
+            stack += name;
+            if (onStack.insert(name).second) {
+                ++m_functions[name].total;
+            }
+            innermost = &name;
+        }
+        ++m_functions[*innermost].self;
+        if (node) {
+            const String statement = "[" + nodeName(node) + "]";
+            stack += ";" + statement;
+            ++m_statements[*innermost + " " + statement];
+        }
+        ++m_stacks[stack];
+    }
+    m_bufferSize = 0;
+}
+
+void LibJS::Profiler::writeCollapsedStacks(std::ostream &stream) const {
+    for (const auto &[stack, samples] : m_stacks) {
+        stream << stack << ' ' << samples << '\n';
+    }
+    stream.flush();
+}
+
+void LibJS::Profiler::printTopEntries(std::ostream &stream, int32_t count) const {
+    const auto percent = [this](int64_t samples) {
+        return m_sampleCount > 0 ? 100.0 * static_cast<double>(samples) / m_sampleCount : 0.0;
+    };
+    stream << "Profile: " << m_sampleCount << " samples every " << m_intervalMicroseconds << " us";
+    if (m_droppedSampleCount > 0) {
+        stream << ", " << m_droppedSampleCount << " dropped";
+    }
+    stream << std::endl;
+    stream << std::fixed << std::setprecision(1);
+    stream << std::setw(16) << "self" << std::setw(16) << "total" << "  function" << std::endl;
+    for (const auto &[name, entry] : topEntries(m_functions, count, [](const Entry &entry) { return entry.self; })) {
+        stream << std::setw(8) << entry.self << std::setw(7) << percent(entry.self) << '%'
+               << std::setw(8) << entry.total << std::setw(7) << percent(entry.total) << "%  " << name << std::endl;
+    }
+    if (m_statements.empty()) {
+        return;
+    }
+    stream << std::setw(16) << "self" << "  statement" << std::endl;
+    for (const auto &[name, samples] : topEntries(m_statements, count, [](int64_t samples) { return samples; })) {
+        stream << std::setw(8) << samples << std::setw(7) << percent(samples) << "%  " << name << std::endl;
+    }
+}
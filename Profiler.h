@@ -0,0 +1,80 @@
+//
+// Sampling profiler attributing CPU time to the JS call stack, see LibJS --profile.
+//
+
+#pragma once
+
+#include <map>
+#include <ostream>
+#include "Types.h"
+#include "Interpreter.h"
+
+namespace LibJS {
+
+    // Samples the interpreter's frames from a SIGPROF timer. The signal handler only copies the frames' layouts into a
+    // buffer allocated up front, names are resolved once profiling stops. Nothing in the interpreter checks for the
+    // profiler, so running without it costs nothing. Which statement a frame executes is only known in builds with
+    // LIBJS_PROFILE_NODES, see Interpreter::enterStatement.
+    class Profiler final {
+    public:
+        static constexpr int32_t DefaultIntervalMicroseconds = 1000;
+        // In words, every sample takes its frame count, its executing node and one layout per frame.
+        static constexpr size_t BufferCapacity = 1 << 20;
+        // Deeper stacks keep their innermost frames.
+        static constexpr int32_t MaxDepth = 256;
+
+        explicit Profiler(Interpreter &interpreter, int32_t intervalMicroseconds = DefaultIntervalMicroseconds);
+
+        Profiler(const Profiler &) = delete;
+
+        Profiler &operator=(const Profiler &) = delete;
+
+        ~Profiler();
+
+        // False where there is no SIGPROF timer, starting the profiler does nothing there.
+        static bool isSupported();
+
+        // The timer signal is process wide, only one profiler can run at a time.
+        void start();
+
+        // Stops sampling and aggregates the samples taken so far.
+        void stop();
+
+        int32_t sampleCount() const { return m_sampleCount; }
+
+        // Samples that didn't fit into the buffer anymore.
+        int32_t droppedSampleCount() const { return m_droppedSampleCount; }
+
+        // One "outer;inner <samples>" line per distinct stack, the format flamegraph.pl and speedscope read. The
+        // program's frame is "(program)", the executing statement is appended in brackets if it is known.
+        void writeCollapsedStacks(std::ostream &stream) const;
+
+        // The `count` functions with the most self samples, along with the samples they were on the stack at all,
+        // followed by the statements with the most self samples if they were recorded.
+        void printTopEntries(std::ostream &stream, int32_t count) const;
+
+    private:
+        struct Entry {
+            int64_t self{0};
+            int64_t total{0};
+        };
+
+        static void handleSignal(int signal);
+
+        void recordSample();
+
+        void aggregate();
+
+        Interpreter &m_interpreter;
+        int32_t m_intervalMicroseconds;
+        Vector<uintptr_t> m_buffer;
+        size_t m_bufferSize{0};
+        int32_t m_sampleCount{0};
+        int32_t m_droppedSampleCount{0};
+        bool m_running{false};
+        std::map<String, int64_t> m_stacks;
+        std::map<String, Entry> m_functions;
+        std::map<String, int64_t> m_statements;
+    };
+
+}
@@ -0,0 +1,90 @@
+//
+// Inline cache for a single property access site, shared by the AST interpreter and the bytecode VM.
+//
+
+#pragma once
+
+#include <array>
+#include "Types.h"
+#include "Value.h"
+
+namespace LibJS {
+
+    // Remembers where the property lives for the last few shapes seen at the site. A site that saw more shapes than
+    // fit into the cache is megamorphic and always takes the slow path.
+    class PropertyCache final {
+    public:
+        static constexpr int32_t Capacity = 4;
+
+        explicit PropertyCache(Atom key)
+                : m_key{key} {}
+
+        Atom key() const { return m_key; }
+
+        Value get(Object &object) {
+            const uint64_t shapeId = object.shape()->id();
+            for (int32_t i = 0; i < m_entryCount; ++i) {
+                const Entry &entry = m_entries[i];
+                if (entry.shapeId == shapeId && !entry.transition) {
+                    return object.slot(entry.slot);
+                }
+            }
+            const int32_t slot = object.shape()->lookup(m_key);
+            if (slot < 0) {
+                return {};
+            }
+            remember(Entry{shapeId, nullptr, slot});
+            return object.slot(slot);
+        }
+
+        // Stores either hit an existing property, or add it by following a cached shape transition.
+        void put(Object &object, const Value &value) {
+            const uint64_t shapeId = object.shape()->id();
+            for (int32_t i = 0; i < m_entryCount; ++i) {
+                const Entry &entry = m_entries[i];
+                if (entry.shapeId == shapeId) {
+                    if (entry.transition) {
+                        object.addProperty(entry.transition, value);
+                    } else {
+                        object.slot(entry.slot) = value;
+                    }
+                    return;
+                }
+            }
+            Shape *shape = object.shape();
+            const int32_t slot = shape->lookup(m_key);
+            if (slot >= 0) {
+                remember(Entry{shapeId, nullptr, slot});
+                object.slot(slot) = value;
+                return;
+            }
+            // The transition is reachable from the old shape, so it is alive whenever a matching object is.
+            Shape *transition = shape->addProperty(m_key);
+            remember(Entry{shapeId, transition, shape->propertyCount()});
+            object.addProperty(transition, value);
+        }
+
+        bool isMegamorphic() const { return m_megamorphic; }
+
+    private:
+        struct Entry {
+            uint64_t shapeId;
+            Shape *transition;
+            int32_t slot;
+        };
+
+        void remember(const Entry &entry) {
+            if (m_entryCount < Capacity) {
+                m_entries[m_entryCount++] = entry;
+            } else {
+                m_megamorphic = true;
+            }
+        }
+
+        Atom m_key;
+        std::array<Entry, Capacity> m_entries{};
+        int32_t m_entryCount{0};
+        bool m_megamorphic{false};
+    };
+
+}
@@ -0,0 +1,73 @@
+//
+// Counters for the runtime's hot paths, compiled in only with the LIBJS_RUNTIME_STATS CMake option.
+//
+
+#include <algorithm>
+#include "RuntimeStats.h"
+
+namespace {
+
+    void printJsonString(std::ostream &stream, std::string_view string) {
+        stream << '"';
+        for (const char character : string) {
+            if (character == '"' || character == '\\') {
+                stream << '\\';
+            }
+            stream << character;
+        }
+        stream << '"';
+    }
+
+}
+
+const char *LibJS::RuntimeStats::phaseName(Phase phase) {
+    switch (phase) {
+        case Phase::Other:
+            return "other";
+        case Phase::Parsing:
+            return "parsing";
+        case Phase::Analysis:
+            return "analysis";
+        case Phase::Compilation:
+            return "compilation";
+        case Phase::Execution:
+            return "execution";
+        case Phase::GarbageCollection:
+            return "garbageCollection";
+    }
+    return "unknown";
+}
+
+void LibJS::RuntimeStats::dumpJson(std::ostream &stream) const {
+    stream << "{\n";
+    stream << "  \"enabled\": " << (Enabled ? "true" : "false") << ",\n";
+    stream << "  \"variableLookups\": " << m_variableLookups << ",\n";
+    stream << "  \"environmentLookups\": " << m_environmentLookups << ",\n";
+    stream << "  \"environmentHops\": " << m_environmentHops << ",\n";
+    stream << "  \"stackFramesPushed\": " << m_stackFramesPushed << ",\n";
+    stream << "  \"cellsAllocated\": " << m_cellsAllocated << ",\n";
+    stream << "  \"stringsAllocated\": " << m_stringsAllocated << ",\n";
+    stream << "  \"bytesAllocated\": " << m_bytesAllocated << ",\n";
+    stream << "  \"collections\": " << m_collections << ",\n";
+
+    stream << "  \"phaseSeconds\": {";
+    for (int32_t i = 0; i < PhaseCount; ++i) {
+        const auto phase = static_cast<Phase>(i);
+        stream << (i > 0 ? ",\n" : "\n") << "    \"" << phaseName(phase) << "\": " << phaseSeconds(phase);
+    }
+    stream << "\n  },\n";
+
+    // Most called first, so the interesting part of a long list comes first.
+    Vector<std::pair<Atom, uint64_t>> calls(m_calls.begin(), m_calls.end());
+    std::sort(calls.begin(), calls.end(), [](const auto &a, const auto &b) {
+        return a.second != b.second ? a.second > b.second : a.first.string() < b.first.string();
+    });
+    stream << "  \"calls\": {";
+    for (size_t i = 0; i < calls.size(); ++i) {
+        stream << (i > 0 ? ",\n" : "\n") << "    ";
+        printJsonString(stream, calls[i].first.string());
+        stream << ": " << calls[i].second;
+    }
+    stream << (calls.empty() ? "}\n" : "\n  }\n");
+    stream << "}" << std::endl;
+}
@@ -0,0 +1,198 @@
+//
+// Counters for the runtime's hot paths, compiled in only with the LIBJS_RUNTIME_STATS CMake option.
+//
+
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <ostream>
+#include <type_traits>
+#include <utility>
+#include "Types.h"
+#include "Atom.h"
+
+#ifndef LIBJS_RUNTIME_STATS
+#define LIBJS_RUNTIME_STATS 0
+#endif
+
+namespace LibJS {
+
+    class PrimitiveString;
+
+    // What a script made the runtime do. Every interpreter owns one, which is the current one of its thread while it
+    // exists, like its heap. Without LIBJS_RUNTIME_STATS every recording function is empty and the counters stay zero.
+    class RuntimeStats final {
+    public:
+        static constexpr bool Enabled = LIBJS_RUNTIME_STATS != 0;
+
+        // Time is charged to the innermost phase only, a function compiled while the program executes counts as
+        // compilation, not execution.
+        enum class Phase : uint8_t {
+            Other,
+            Parsing,
+            Analysis,
+            Compilation,
+            Execution,
+            GarbageCollection
+        };
+
+        static constexpr int32_t PhaseCount = static_cast<int32_t>(Phase::GarbageCollection) + 1;
+
+        RuntimeStats() : m_previous{s_current} {
+            s_current = this;
+        }
+
+        RuntimeStats(const RuntimeStats &) = delete;
+
+        RuntimeStats &operator=(const RuntimeStats &) = delete;
+
+        ~RuntimeStats() {
+            assert(s_current == this);
+            s_current = m_previous;
+        }
+
+        // nullptr while there is no interpreter.
+        static RuntimeStats *current() { return s_current; }
+
+        // A variable access through Interpreter::getVariable or setVariable, the tree-walker's path.
+        void recordVariableLookup() {
+            if constexpr (Enabled) {
+                ++m_variableLookups;
+            }
+        }
+
+        // An access to a captured variable in any tier, walking `hops` environments up the chain.
+        void recordEnvironmentLookup(int32_t hops) {
+            if constexpr (Enabled) {
+                ++m_environmentLookups;
+                m_environmentHops += hops;
+            }
+        }
+
+        void recordStackFramePush() {
+            if constexpr (Enabled) {
+                ++m_stackFramesPushed;
+            }
+        }
+
+        // Functions are told apart by name, functions with the same name share their count.
+        void recordCall(Atom function) {
+            if constexpr (Enabled) {
+                ++m_calls[function];
+            }
+        }
+
+        void recordCollection() {
+            if constexpr (Enabled) {
+                ++m_collections;
+            }
+        }
+
+        // Called by Heap::allocate, cells allocated without an interpreter aren't counted. Bytes are those of the cell
+        // itself, not what it allocates on its own like the characters of a string.
+        template<typename T>
+        static void recordAllocation() {
+            if constexpr (Enabled) {
+                if (RuntimeStats *stats = s_current) {
+                    ++stats->m_cellsAllocated;
+                    stats->m_bytesAllocated += sizeof(T);
+                    if constexpr (std::is_same_v<T, PrimitiveString>) {
+                        ++stats->m_stringsAllocated;
+                    }
+                }
+            }
+        }
+
+        // Charges the time until the scope ends to `phase` in the current stats.
+        class PhaseScope final {
+        public:
+            explicit PhaseScope([[maybe_unused]] Phase phase) {
+                if constexpr (Enabled) {
+                    m_stats = s_current;
+                    if (m_stats) {
+                        m_previous = m_stats->switchPhase(phase);
+                    }
+                }
+            }
+
+            PhaseScope(const PhaseScope &) = delete;
+
+            PhaseScope &operator=(const PhaseScope &) = delete;
+
+            ~PhaseScope() {
+                if constexpr (Enabled) {
+                    if (m_stats) {
+                        m_stats->switchPhase(m_previous);
+                    }
+                }
+            }
+
+        private:
+            RuntimeStats *m_stats{nullptr};
+            Phase m_previous{Phase::Other};
+        };
+
+        uint64_t variableLookups() const { return m_variableLookups; }
+
+        uint64_t environmentLookups() const { return m_environmentLookups; }
+
+        uint64_t environmentHops() const { return m_environmentHops; }
+
+        uint64_t stackFramesPushed() const { return m_stackFramesPushed; }
+
+        uint64_t cellsAllocated() const { return m_cellsAllocated; }
+
+        uint64_t stringsAllocated() const { return m_stringsAllocated; }
+
+        uint64_t bytesAllocated() const { return m_bytesAllocated; }
+
+        uint64_t collections() const { return m_collections; }
+
+        uint64_t calls(Atom function) const {
+            const auto found = m_calls.find(function);
+            return found != m_calls.end() ? found->second : 0;
+        }
+
+        const HashSet<Atom, uint64_t> &calls() const { return m_calls; }
+
+        // Includes the running phase up to now.
+        double phaseSeconds(Phase phase) const {
+            std::chrono::steady_clock::duration duration = m_phaseDurations[static_cast<int32_t>(phase)];
+            if (phase == m_phase) {
+                duration += std::chrono::steady_clock::now() - m_phaseStart;
+            }
+            return std::chrono::duration<double>(duration).count();
+        }
+
+        static const char *phaseName(Phase phase);
+
+        // A single JSON object with every counter, calls per function and seconds per phase.
+        void dumpJson(std::ostream &stream) const;
+
+    private:
+        Phase switchPhase(Phase phase) {
+            const auto now = std::chrono::steady_clock::now();
+            m_phaseDurations[static_cast<int32_t>(m_phase)] += now - m_phaseStart;
+            m_phaseStart = now;
+            return std::exchange(m_phase, phase);
+        }
+
+        static inline thread_local RuntimeStats *s_current{nullptr};
+
+        RuntimeStats *m_previous;
+        uint64_t m_variableLookups{0};
+        uint64_t m_environmentLookups{0};
+        uint64_t m_environmentHops{0};
+        uint64_t m_stackFramesPushed{0};
+        uint64_t m_cellsAllocated{0};
+        uint64_t m_stringsAllocated{0};
+        uint64_t m_bytesAllocated{0};
+        uint64_t m_collections{0};
+        HashSet<Atom, uint64_t> m_calls;
+        Phase m_phase{Phase::Other};
+        std::chrono::steady_clock::time_point m_phaseStart{std::chrono::steady_clock::now()};
+        std::array<std::chrono::steady_clock::duration, PhaseCount> m_phaseDurations{};
+    };
+
+}
@@ -0,0 +1,221 @@
+//
+// Scope analysis: assigns every declared name a slot in its function (or program) frame and resolves identifiers to
+// locations, so the interpreter never has to look variables up by name.
+//
+
+#pragma once
+
+#include <algorithm>
+#include <unordered_set>
+#include "Types.h"
+#include "Atom.h"
+
+namespace LibJS {
+
+    // Where a variable lives at runtime. Only variables captured by inner functions are kept in heap allocated
+    // environments, everything else stays in its frame.
+    struct VariableLocation {
+        enum class Kind : uint8_t {
+            Unresolved,
+            // Slot `index` of the current frame.
+            Local,
+            // Slot `index` of the global frame, for program level variables used inside of functions.
+            Global,
+            // Slot `index` of the environment `hops` levels up from the current frame's environment.
+            Environment
+        };
+
+        Kind kind{Kind::Unresolved};
+        int32_t hops{0};
+        int32_t index{-1};
+
+        bool isResolved() const { return kind != Kind::Unresolved; }
+
+        bool isLocal() const { return kind == Kind::Local; }
+    };
+
+    // Slot layout of a program or function frame. Slot names are only kept for dumping and for findSlot.
+    class FrameLayout {
+    public:
+        int32_t slotCount() const { return static_cast<int32_t>(m_slotNames.size()); }
+
+        Atom slotName(int32_t slot) const { return m_slotNames[slot]; }
+
+        // The slot of a name declared in this frame outside of any block, -1 if there is none.
+        int32_t findSlot(Atom name) const {
+            for (int32_t slot = 0; slot < slotCount(); ++slot) {
+                if (m_slotNames[slot] == name && !isBlockScoped(slot)) {
+                    return slot;
+                }
+            }
+            return -1;
+        }
+
+        // The name of the function the frame belongs to, empty for the program. Only kept for the profiler.
+        Atom functionName() const { return m_functionName; }
+
+        void setFunctionName(Atom name) { m_functionName = name; }
+
+        int32_t addSlot(Atom name, bool blockScoped = false) {
+            m_slotNames.push_back(name);
+            m_blockScoped.push_back(blockScoped);
+            return slotCount() - 1;
+        }
+
+        // Slots of names declared in a block, like a catch parameter, are only in use while the block runs.
+        bool isBlockScoped(int32_t slot) const { return m_blockScoped[slot]; }
+
+        // Parameters take the first slots, arguments are bound to them by position.
+        int32_t parameterCount() const { return m_parameterCount; }
+
+        void setParameterCount(int32_t count) { m_parameterCount = count; }
+
+        // Names declared in this frame that inner functions refer to, found by the first analysis pass. Each of them
+        // gets a slot in the environment a frame with this layout allocates when it is pushed.
+        bool isCaptured(Atom name) const { return m_captured.count(name) != 0; }
+
+        void markCaptured(Atom name) { m_captured.insert(name); }
+
+        int32_t environmentSize() const { return m_environmentSize; }
+
+        int32_t addEnvironmentSlot() { return m_environmentSize++; }
+
+        // Captured parameters are copied from their argument slot into the environment when the frame is pushed.
+        struct CapturedParameter {
+            int32_t slot;
+            int32_t index;
+        };
+
+        Span<const CapturedParameter> capturedParameters() const { return m_capturedParameters; }
+
+        void addCapturedParameter(int32_t slot, int32_t index) { m_capturedParameters.push_back({slot, index}); }
+
+        // Names a program assigns without declaring them, found by the first analysis pass. The second one declares
+        // them up front, so every use of them resolves to the same global slot.
+        Span<const Atom> implicitGlobals() const { return m_implicitGlobals; }
+
+        void addImplicitGlobal(Atom name) { m_implicitGlobals.push_back(name); }
+
+        // Everything but the captured names and implicit globals is recomputed by the second analysis pass.
+        void clear() {
+            m_slotNames.clear();
+            m_blockScoped.clear();
+            m_parameterCount = 0;
+            m_environmentSize = 0;
+            m_capturedParameters.clear();
+        }
+
+    private:
+        Vector<Atom> m_slotNames;
+        Vector<bool> m_blockScoped;
+        Atom m_functionName;
+        int32_t m_parameterCount{0};
+        std::unordered_set<Atom> m_captured;
+        int32_t m_environmentSize{0};
+        Vector<CapturedParameter> m_capturedParameters;
+        Vector<Atom> m_implicitGlobals;
+    };
+
+    // Analysis runs twice over the program. The first pass finds which variables inner functions capture, the second
+    // one assigns the final locations, with captured variables moved into their frame's environment.
+    class ScopeAnalyzer final {
+    public:
+        void enterScope(FrameLayout &layout) {
+            layout.clear();
+            m_scopes.push_back(Scope{&layout, {}, false});
+            if (m_scopes.size() == 1) {
+                for (const Atom name : layout.implicitGlobals()) {
+                    declare(name);
+                }
+            }
+        }
+
+        // Names declared in a block scope get slots of their own in the enclosing frame and are only visible inside of
+        // the block, they shadow names of the frame without touching their slots.
+        void enterBlockScope() {
+            assert(!m_scopes.empty());
+            m_scopes.push_back(Scope{m_scopes.back().layout, {}, true});
+        }
+
+        void leaveScope() {
+            m_scopes.pop_back();
+        }
+
+        // Declaring a name twice in the same scope yields the same slot, like `var` redeclarations do.
+        VariableLocation declare(Atom name) {
+            assert(!m_scopes.empty());
+            return declareIn(m_scopes.back(), name);
+        }
+
+        // Assigning a name that isn't declared anywhere creates a global variable, like it does in a sloppy mode
+        // script, instead of leaving the store without a location.
+        VariableLocation resolveAssignmentTarget(Atom name) {
+            const bool declared = std::any_of(m_scopes.begin(), m_scopes.end(), [&](const Scope &scope) {
+                return scope.locations.count(name) != 0;
+            });
+            if (!declared) {
+                Scope &program = m_scopes.front();
+                program.layout->addImplicitGlobal(name);
+                declareIn(program, name);
+            }
+            return resolve(name);
+        }
+
+        // The outermost scope is the program's, its variables live in the global frame for as long as the program
+        // runs and are never captured. Block scopes belong to the frame of the scope they are in.
+        VariableLocation resolve(Atom name) const {
+            const auto current = static_cast<int32_t>(m_scopes.size()) - 1;
+            for (int32_t i = current; i >= 0; --i) {
+                const Scope &scope = m_scopes[i];
+                auto found = scope.locations.find(name);
+                if (found == scope.locations.end()) {
+                    continue;
+                }
+                const VariableLocation &location = found->second;
+                if (scope.layout == m_scopes[current].layout) {
+                    return location;
+                }
+                if (scope.layout == m_scopes.front().layout) {
+                    return {VariableLocation::Kind::Global, 0, location.index};
+                }
+                scope.layout->markCaptured(name);
+                if (location.kind != VariableLocation::Kind::Environment) {
+                    return {}; // First pass, the variable only moves into the environment in the second one
+                }
+                // Frames without captured variables of their own share their closure's environment.
+                int32_t hops = 0;
+                for (int32_t j = i + 1; j <= current; ++j) {
+                    if (!m_scopes[j].isBlock && m_scopes[j].layout->environmentSize() > 0) {
+                        ++hops;
+                    }
+                }
+                return {VariableLocation::Kind::Environment, hops, location.index};
+            }
+            return {}; // Not declared anywhere, reads yield undefined
+        }
+
+    private:
+        struct Scope {
+            FrameLayout *layout;
+            HashSet<Atom, VariableLocation> locations;
+            bool isBlock;
+        };
+
+        VariableLocation declareIn(Scope &scope, Atom name) {
+            auto found = scope.locations.find(name);
+            if (found != scope.locations.end()) {
+                return found->second;
+            }
+            const int32_t slot = scope.layout->addSlot(name, scope.isBlock);
+            VariableLocation location{VariableLocation::Kind::Local, 0, slot};
+            if (scope.layout->isCaptured(name)) {
+                location = {VariableLocation::Kind::Environment, 0, scope.layout->addEnvironmentSlot()};
+            }
+            scope.locations.emplace(name, location);
+            return location;
+        }
+
+        Vector<Scope> m_scopes;
+    };
+
+}
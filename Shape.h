@@ -0,0 +1,72 @@
+//
+// Hidden classes. Objects with the same properties added in the same order share a Shape, which maps property keys to
+// slots in the objects' contiguous slot arrays.
+//
+
+#pragma once
+
+#include <atomic>
+#include "Types.h"
+#include "Atom.h"
+#include "Cell.h"
+#include "Heap.h"
+
+namespace LibJS {
+
+    class Shape final : public Cell {
+    public:
+        // The empty root of a transition tree.
+        Shape() : m_id{nextId()} {}
+
+        Shape(Shape *parent, Atom key)
+                : m_parent{parent},
+                  m_slots{parent->m_slots},
+                  m_id{nextId()} {
+            m_slots.emplace(key, static_cast<int32_t>(m_slots.size()));
+        }
+
+        // -1 if objects of this shape don't have the property.
+        int32_t lookup(Atom key) const {
+            auto found = m_slots.find(key);
+            return found != m_slots.end() ? found->second : -1;
+        }
+
+        // Objects adding the same key to the same shape end up sharing the resulting shape.
+        Shape *addProperty(Atom key) {
+            assert(lookup(key) < 0);
+            auto found = m_transitions.find(key);
+            if (found != m_transitions.end()) {
+                return found->second;
+            }
+            Shape *shape = Heap::current().allocate<Shape>(this, key);
+            m_transitions.emplace(key, shape);
+            return shape;
+        }
+
+        int32_t propertyCount() const { return static_cast<int32_t>(m_slots.size()); }
+
+        // Unique across all heaps, inline caches compare ids so they never confuse a dead shape with a new one that
+        // got allocated at the same address.
+        uint64_t id() const { return m_id; }
+
+        // Transitions are strong, so a tree lives as long as its root.
+        virtual void visitEdges(Visitor &visitor) override {
+            visitor.visit(m_parent);
+            for (const auto &transition : m_transitions) {
+                visitor.visit(transition.second);
+            }
+        }
+
+    private:
+        static uint64_t nextId() {
+            static std::atomic<uint64_t> s_nextId{1};
+            return s_nextId.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        Shape *m_parent{nullptr};
+        HashSet<Atom, int32_t> m_slots;
+        HashSet<Atom, Shape *> m_transitions;
+        uint64_t m_id;
+    };
+
+}
@@ -0,0 +1,120 @@
+//
+// Binary operator site of the AST interpreter that specializes itself on the operand types it has seen.
+//
+
+#pragma once
+
+#include <array>
+#include <utility>
+#include "Types.h"
+#include "Value.h"
+#include "Operators.h"
+
+namespace LibJS {
+
+    // Starts out uninitialized and rewrites itself on first execution into the variant matching the operands. Each
+    // variant guards its assumption, and a failed guard rewrites the site into a more general variant:
+    // Uninitialized -> Int32 -> Double -> Generic. Sites never go back to a more specialized variant, so code that
+    // mixes types settles down instead of flip-flopping.
+    class SpecializingOperator final {
+    public:
+        enum class Specialization : uint8_t {
+            Uninitialized,
+            Int32,
+            Double,
+            Generic
+        };
+
+        explicit SpecializingOperator(BinaryOperator op)
+                : m_operator{op},
+                  m_handler{&executeUninitialized} {}
+
+        BinaryOperator op() const { return m_operator; }
+
+        Specialization specialization() const { return m_specialization; }
+
+        Value execute(const Value &left, const Value &right) {
+            return m_handler(*this, left, right);
+        }
+
+    private:
+        using Handler = Value (*)(SpecializingOperator &site, const Value &left, const Value &right);
+
+        static bool isNumeric(const Value &value) {
+            return value.isInt() || value.isNumber();
+        }
+
+        static double asNumber(const Value &value) {
+            return value.isInt() ? value.asInt32() : value.asDouble();
+        }
+
+        static Value executeUninitialized(SpecializingOperator &site, const Value &left, const Value &right) {
+            if (left.isInt() && right.isInt()) {
+                site.rewrite(Specialization::Int32);
+            } else if (isNumeric(left) && isNumeric(right)) {
+                site.rewrite(Specialization::Double);
+            } else {
+                site.rewrite(Specialization::Generic);
+            }
+            return site.execute(left, right);
+        }
+
+        template<BinaryOperator op>
+        static Value executeInt32(SpecializingOperator &site, const Value &left, const Value &right) {
+            if (left.isInt() && right.isInt()) [[likely]] {
+                return int32Operation<op>(left.asInt32(), right.asInt32());
+            }
+            site.rewrite(isNumeric(left) && isNumeric(right) ? Specialization::Double : Specialization::Generic);
+            return site.execute(left, right);
+        }
+
+        template<BinaryOperator op>
+        static Value executeDouble(SpecializingOperator &site, const Value &left, const Value &right) {
+            if (isNumeric(left) && isNumeric(right)) [[likely]] {
+                return doubleOperation<op>(asNumber(left), asNumber(right));
+            }
+            site.rewrite(Specialization::Generic);
+            return site.execute(left, right);
+        }
+
+        static Value executeGeneric(SpecializingOperator &site, const Value &left, const Value &right) {
+            return binaryOperation(site.m_operator, left, right);
+        }
+
+        template<size_t... ops>
+        static constexpr std::array<Handler, BinaryOperatorCount> int32Handlers(std::index_sequence<ops...>) {
+            return {&executeInt32<static_cast<BinaryOperator>(ops)>...};
+        }
+
+        template<size_t... ops>
+        static constexpr std::array<Handler, BinaryOperatorCount> doubleHandlers(std::index_sequence<ops...>) {
+            return {&executeDouble<static_cast<BinaryOperator>(ops)>...};
+        }
+
+        void rewrite(Specialization specialization) {
+            static constexpr auto s_int32Handlers = int32Handlers(std::make_index_sequence<BinaryOperatorCount>());
+            static constexpr auto s_doubleHandlers = doubleHandlers(std::make_index_sequence<BinaryOperatorCount>());
+
+            m_specialization = specialization;
+            switch (specialization) {
+                case Specialization::Int32:
+                    m_handler = s_int32Handlers[static_cast<size_t>(m_operator)];
+                    break;
+                case Specialization::Double:
+                    m_handler = s_doubleHandlers[static_cast<size_t>(m_operator)];
+                    break;
+                case Specialization::Generic:
+                    m_handler = &executeGeneric;
+                    break;
+                default:
+                    assert(false);
+                    break;
+            }
+        }
+
+        BinaryOperator m_operator;
+        Specialization m_specialization{Specialization::Uninitialized};
+        Handler m_handler;
+    };
+
+}
@@ -0,0 +1,65 @@
+//
+// Parser tests, run by ctest. Exits with 1 if any check fails.
+//
+
+#include <iostream>
+#include "Parser.h"
+
+namespace {
+
+    int32_t g_failures = 0;
+
+    LibJS::String repeat(std::string_view string, int32_t count) {
+        LibJS::String result;
+        result.reserve(string.size() * count);
+        for (int32_t i = 0; i < count; ++i) {
+            result += string;
+        }
+        return result;
+    }
+
+    // Parses `source` and checks that it fails with an error containing `expectedError`, or that it parses if that
+    // is empty.
+    void checkParse(std::string_view name, const LibJS::String &source, std::string_view expectedError = {}) {
+        LibJS::Parser parser(source);
+        parser.parseProgram();
+        const bool passed = expectedError.empty()
+                            ? !parser.hasError()
+                            : parser.hasError() && parser.error().find(expectedError) != LibJS::String::npos;
+        if (!passed) {
+            ++g_failures;
+            std::cerr << "FAIL " << name << ": " << (parser.hasError() ? parser.error() : "no error") << std::endl;
+        }
+    }
+
+}
+
+int main() {
+    constexpr std::string_view tooDeep = "Too deeply nested";
+
+    // Deeper than the limit overflowed the native stack before.
+    checkParse("parentheses", "var x = " + repeat("(", 200000) + "1" + repeat(")", 200000) + ";", tooDeep);
+    checkParse("unary minus", "var x = " + repeat("- ", 100000) + "y;", tooDeep);
+    checkParse("prefix decrement", "var x = " + repeat("--", 50000) + "y;", tooDeep);
+    checkParse("binary chain", "var x = 1" + repeat(" + 1", 200000) + ";", tooDeep);
+    checkParse("member chain", "var o = {}; var x = o" + repeat(".a", 200000) + ";", tooDeep);
+    checkParse("call chain", "f" + repeat("()", 200000) + ";", tooDeep);
+    checkParse("blocks", repeat("{", 200000) + repeat("}", 200000), tooDeep);
+
+    // Below the limit, with room for the statement and declaration around them.
+    checkParse("shallow parentheses", "var x = " + repeat("(", 900) + "1" + repeat(")", 900) + ";");
+    checkParse("shallow unary minus", "var x = " + repeat("- ", 900) + "y;");
+    checkParse("shallow binary chain", "var x = 1" + repeat(" + 1", 900) + ";");
+    checkParse("shallow blocks", repeat("{", 900) + repeat("}", 900));
+
+    // A return outside of a function has nothing to return from.
+    checkParse("return at the top level", "function f() {} return f();", "Illegal return statement");
+    checkParse("return in a top level block", "{ return; }", "Illegal return statement");
+    checkParse("return in a function", "function f() { { return 1; } } function g() { return; }");
+
+    if (g_failures > 0) {
+        std::cerr << g_failures << " parser checks failed" << std::endl;
+        return 1;
+    }
+    return 0;
+}
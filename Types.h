@@ -4,6 +4,7 @@
 
 #pragma once
 
+#include <cstdint>
 #include <variant>
 #include <string>
 #include <memory>
@@ -11,6 +12,7 @@
 #include <stack>
 #include <unordered_map>
 #include <optional>
+#include <span>
 #include <assert.h>
 
 namespace LibJS {
@@ -40,6 +42,9 @@ namespace LibJS {
     template<typename T>
     using Optional = std::optional<T>;
 
+    template<typename T>
+    using Span = std::span<T>;
+
     template<typename First, typename Second>
     using Pair = std::pair<First, Second>;
 }
\ No newline at end of file
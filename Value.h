@@ -5,40 +5,52 @@
 
 #include <utility>
 #include <iostream>
+#include <cmath>
+#include <cstring>
+#include <type_traits>
 #include "Types.h"
+#include "Cell.h"
+#include "Heap.h"
+#include "Shape.h"
+#include "PrimitiveString.h"
+#include "BigInt.h"
 
 namespace LibJS {
-    class BigInt;
-
     class Value;
 
     class ScopeNode;
 
-    class Function {
+    class FunctionDeclaration;
+
+    class Object;
+
+    class Environment;
+
+    class Function final : public Cell {
     public:
-        Function(const String &name, SharedPtr<class BlockStatement> body)
+        Function(Atom name, FunctionDeclaration *declaration, Environment *environment)
                 : m_name(name),
-                  m_body{std::move(body)} {}
+                  m_declaration{declaration},
+                  m_environment{environment} {}
 
-        Function(const String &name) {
-            m_name = name;
-        }
-
-        ~Function() {
-            std::cout << "Out of scope" << std::endl;
-        }
+        Function(Atom name)
+                : m_name(name) {}
 
         String toString() const {
-            return "function " + m_name + "() { [native code] }";
+            return "function " + String(m_name.string()) + "() { [native code] }";
         }
 
-        SharedPtr<BlockStatement> body() {
-            return m_body;
-        }
+        FunctionDeclaration *declaration() const { return m_declaration; }
+
+        // The captured variables of the enclosing functions, null if the function doesn't capture any.
+        Environment *environment() const { return m_environment; }
+
+        virtual void visitEdges(Visitor &visitor) override;
 
     private:
-        String m_name;
-        SharedPtr<BlockStatement> m_body;
+        Atom m_name;
+        FunctionDeclaration *m_declaration{nullptr};
+        Environment *m_environment{nullptr};
     };
 
     class Value {
@@ -55,76 +67,157 @@ namespace LibJS {
             Function
         };
 
-        Value() : m_type(Type::Undefined) {}
+        Value() : m_bits{tagBits(UndefinedTag)} {}
 
-        explicit Value(SharedPtr<Function> function) : m_type{Type::Function},
-                                                       m_valueAsFunction{function} {}
+        explicit Value(Function *function) : Value(FunctionTag, function) {}
 
-        explicit Value(float value) : m_type{Type::Number}, m_valueAsDouble{value} {}
+        explicit Value(float value) : Value(static_cast<double>(value)) {}
 
-        explicit Value(double value) : m_type{Type::Number}, m_valueAsDouble{value} {}
+        explicit Value(double value) {
+            if (std::isnan(value)) {
+                m_bits = CanonicalNaN;
+            } else {
+                std::memcpy(&m_bits, &value, sizeof(value));
+            }
+        }
+
+        explicit Value(int32_t value)
+                : m_bits{tagBits(Int32Tag) | static_cast<uint32_t>(value)} {}
+
+        explicit Value(bool value)
+                : m_bits{tagBits(BooleanTag) | static_cast<uint64_t>(value)} {}
+
+        explicit Value(String value) : Value(StringTag, Heap::current().allocate<PrimitiveString>(std::move(value))) {}
+
+        explicit Value(PrimitiveString *string) : Value(StringTag, string) {}
 
-        explicit Value(int32_t value) : m_type{Type::Int}, m_valueAsInt32{value} {}
+        explicit Value(const BigInt *value) : Value(BigIntTag, const_cast<BigInt *>(value)) {}
 
-        explicit Value(bool value) : m_type{Type::Boolean}, m_valueAsBool{value} {}
+        explicit Value(Object *object);
+
+        static Value null() {
+            Value value;
+            value.m_bits = tagBits(NullTag);
+            return value;
+        }
+
+        Type type() const {
+            switch (tag()) {
+                case UndefinedTag:
+                    return Type::Undefined;
+                case NullTag:
+                    return Type::Null;
+                case BooleanTag:
+                    return Type::Boolean;
+                case Int32Tag:
+                    return Type::Int;
+                case StringTag:
+                    return Type::String;
+                case BigIntTag:
+                    return Type::BigInt;
+                case ObjectTag:
+                    return Type::Object;
+                case FunctionTag:
+                    return Type::Function;
+                default:
+                    return Type::Number;
+            }
+        }
 
-        explicit Value(String value) : m_type{Type::String}, m_valueAsString{value} {}
+        // Raw NaN-boxed representation, see the tag layout below.
+        uint64_t encoded() const { return m_bits; }
 
-        explicit Value(const BigInt *value)
-                : m_type{Type::BigInt} {
-            m_valueAsBigInt = const_cast<BigInt *>(value);
+        static Value fromEncoded(uint64_t bits) {
+            Value value;
+            value.m_bits = bits;
+            return value;
         }
 
+        // The parts of the encoding machine code needs to test and build Values itself, see JIT.cpp. A Value is an Int
+        // or Boolean if its upper 16 bits equal the tag's, and a double if it isn't all ones under the NaN-box mask.
+        static constexpr uint16_t int32Tag() { return Int32Tag; }
+
+        static constexpr uint16_t booleanTag() { return BooleanTag; }
+
+        static constexpr uint64_t nanBoxMask() { return NaNBoxMask; }
+
         bool asBool() const {
-            return std::get<bool>(m_valueAsBool);
+            assert(isBoolean());
+            return m_bits & 1;
         }
 
         double asDouble() const {
-            return std::get<double>(m_valueAsDouble);
+            assert(isNumber());
+            double value;
+            std::memcpy(&value, &m_bits, sizeof(value));
+            return value;
         }
 
         int32_t asInt32() const {
-            return std::get<int32_t>(m_valueAsInt32);
+            assert(isInt());
+            return static_cast<int32_t>(static_cast<uint32_t>(m_bits));
         }
 
         const String &asString() const {
-            return std::get<String>(m_valueAsString);
+            assert(isString());
+            return static_cast<PrimitiveString *>(asCell())->string();
         }
 
-        SharedPtr<Function> asFunction() const {
-            return std::get<SharedPtr<Function>>(m_valueAsFunction);
+        PrimitiveString *asPrimitiveString() const {
+            assert(isString());
+            return static_cast<PrimitiveString *>(asCell());
         }
 
+        Function *asFunction() const {
+            assert(isFunction());
+            return static_cast<Function *>(asCell());
+        }
+
+        BigInt *asBigInt() const {
+            assert(isBigInt());
+            return static_cast<BigInt *>(asCell());
+        }
+
+        Object *asObject() const;
+
         bool isBoolean() const {
-            return m_type == Type::Boolean;
+            return tag() == BooleanTag;
         }
 
         bool isNumber() const {
-            return m_type == Type::Number;
+            return (m_bits & NaNBoxMask) != NaNBoxMask || m_bits == CanonicalNaN;
         }
 
         bool isObject() const {
-            return m_type == Type::Object;
+            return tag() == ObjectTag;
         }
 
         bool isUndefined() const {
-            return m_type == Type::Undefined;
+            return tag() == UndefinedTag;
         }
 
         bool isNull() const {
-            return m_type == Type::Null;
+            return tag() == NullTag;
         }
 
         bool isString() const {
-            return m_type == Type::String;
+            return tag() == StringTag;
+        }
+
+        bool isBigInt() const {
+            return tag() == BigIntTag;
         }
 
         bool isInt() const {
-            return m_type == Type::Int;
+            return tag() == Int32Tag;
         }
 
         bool isFunction() const {
-            return m_type == Type::Function;
+            return tag() == FunctionTag;
+        }
+
+        bool isCell() const {
+            return (m_bits & CellMask) == CellMask;
         }
 
         String toString() const {
@@ -152,10 +245,18 @@ namespace LibJS {
                 return std::to_string(asInt32());
             }
 
+            if (isBigInt()) {
+                return asBigInt()->toString();
+            }
+
             if (isFunction()) {
                 return asFunction()->toString();
             }
 
+            if (isObject()) {
+                return "[object Object]";
+            }
+
             return "Type not defined";
         }
 
@@ -165,7 +266,7 @@ namespace LibJS {
             }
 
             if (isString()) {
-                return asString().length() > 0;
+                return asPrimitiveString()->length() > 0;
             }
 
             if (isNumber()) {
@@ -183,12 +284,141 @@ namespace LibJS {
             return false;
         }
 
+        // Values don't own their cell, the Heap keeps it alive as long as the Value is reachable from a root.
+        void visitEdges(Cell::Visitor &visitor) const {
+            if (isCell()) {
+                visitor.visit(asCell());
+            }
+        }
+
     private:
-        Type m_type;
-        Variant<double, bool, int32_t, String, BigInt *, SharedPtr<Function>> m_valueAsDouble, m_valueAsBool,
-                m_valueAsInt32, m_valueAsString, m_valueAsBigInt, m_valueAsFunction;
+        // Every double is stored as is, all NaNs are canonicalized to CanonicalNaN. That leaves the other quiet NaN
+        // bit patterns free to encode the remaining types: the upper 16 bits hold the tag and the lower 48 bits the
+        // payload. Tags with the sign bit set carry a Cell pointer, which fits into 48 bits on current 64 bit CPUs.
+        static constexpr uint64_t TagShift = 48;
+        static constexpr uint64_t PayloadMask = 0x0000FFFFFFFFFFFFull;
+        static constexpr uint64_t CanonicalNaN = 0x7FF8000000000000ull;
+        static constexpr uint64_t NaNBoxMask = 0x7FF8000000000000ull;
+        static constexpr uint64_t CellMask = 0xFFF8000000000000ull;
+
+        enum Tag : uint16_t {
+            UndefinedTag = 0x7FF9,
+            NullTag = 0x7FFA,
+            BooleanTag = 0x7FFB,
+            Int32Tag = 0x7FFC,
+            StringTag = 0xFFF9,
+            BigIntTag = 0xFFFA,
+            ObjectTag = 0xFFFB,
+            FunctionTag = 0xFFFC,
+        };
+
+        static constexpr uint64_t tagBits(Tag tag) {
+            return static_cast<uint64_t>(tag) << TagShift;
+        }
+
+        Value(Tag tag, Cell *cell)
+                : m_bits{tagBits(tag) | reinterpret_cast<uint64_t>(cell)} {
+            assert((reinterpret_cast<uint64_t>(cell) & ~PayloadMask) == 0);
+        }
+
+        uint16_t tag() const {
+            return static_cast<uint16_t>(m_bits >> TagShift);
+        }
+
+        Cell *asCell() const {
+            return reinterpret_cast<Cell *>(m_bits & PayloadMask);
+        }
+
+        uint64_t m_bits;
     };
 
+    static_assert(sizeof(Value) == sizeof(uint64_t));
+    static_assert(std::is_trivially_copyable_v<Value>);
+
+    // Properties live in a contiguous slot array, the object's Shape knows which key is in which slot.
+    class Object final : public Cell {
+    public:
+        explicit Object(Shape *shape)
+                : m_shape{shape} {
+            assert(shape->propertyCount() == 0);
+        }
+
+        Shape *shape() const { return m_shape; }
+
+        Value get(Atom key) const {
+            const int32_t slot = m_shape->lookup(key);
+            return slot >= 0 ? m_slots[slot] : Value();
+        }
+
+        void put(Atom key, const Value &value) {
+            const int32_t slot = m_shape->lookup(key);
+            if (slot >= 0) {
+                m_slots[slot] = value;
+            } else {
+                addProperty(m_shape->addProperty(key), value);
+            }
+        }
+
+        // Direct slot access for callers that already resolved the key against shape().
+        Value &slot(int32_t index) { return m_slots[index]; }
+
+        // `shape` has to be the transition from the current shape that adds the new property.
+        void addProperty(Shape *shape, const Value &value) {
+            assert(shape->propertyCount() == static_cast<int32_t>(m_slots.size()) + 1);
+            m_shape = shape;
+            m_slots.push_back(value);
+        }
+
+        virtual void visitEdges(Visitor &visitor) override {
+            visitor.visit(m_shape);
+            for (const auto &value : m_slots) {
+                value.visitEdges(visitor);
+            }
+        }
+
+    private:
+        Shape *m_shape;
+        Vector<Value> m_slots;
+    };
+
+    // Heap allocated storage for the variables of a frame that inner functions capture, so they outlive the frame.
+    // Environments chain to the environment of the function that created them.
+    class Environment final : public Cell {
+    public:
+        Environment(int32_t size, Environment *parent)
+                : m_slots(size),
+                  m_parent{parent} {}
+
+        Value &slot(int32_t index) {
+            assert(index < static_cast<int32_t>(m_slots.size()));
+            return m_slots[index];
+        }
+
+        Environment *parent() const { return m_parent; }
+
+        virtual void visitEdges(Visitor &visitor) override {
+            for (const auto &value : m_slots) {
+                value.visitEdges(visitor);
+            }
+            visitor.visit(m_parent);
+        }
+
+    private:
+        Vector<Value> m_slots;
+        Environment *m_parent;
+    };
+
+    inline void Function::visitEdges(Visitor &visitor) {
+        visitor.visit(m_environment);
+    }
+
+    inline Value::Value(Object *object) : Value(ObjectTag, object) {}
+
+    inline Object *Value::asObject() const {
+        assert(isObject());
+        return static_cast<Object *>(asCell());
+    }
+
 
     Value add(const Value &left, const Value &right);
 
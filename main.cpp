@@ -1,6 +1,15 @@
 #include <iostream>
+#include <fstream>
+#include <sstream>
+#include <cstring>
+#include <cstdlib>
+#include <algorithm>
 #include "Types.h"
 #include "AST.h"
+#include "CodeCache.h"
+#include "Parser.h"
+#include "Profiler.h"
+#include "Benchmarks/WorkloadRunner.h"
 
 
 /**
@@ -14,53 +23,53 @@
 //  }
 //  inc();
 
-int main() {
+static LibJS::UniquePtr<LibJS::Program> buildDemoProgram() {
     LibJS::UniquePtr<LibJS::Program> program = std::make_unique<LibJS::Program>(LibJS::Program::SourceType::Script);
     program->append<LibJS::VariableDeclaration>(
             LibJS::VariableDeclaration::Kind::Const,
-            std::vector<LibJS::SharedPtr<LibJS::VariableDeclarator>>{
-                    std::make_shared<LibJS::VariableDeclarator>(
-                            std::make_unique<LibJS::Identifier>("b"),
-                            std::make_unique<LibJS::BinaryExpression>(
+            program->makeArray<LibJS::VariableDeclarator *>({
+                    program->make<LibJS::VariableDeclarator>(
+                            program->make<LibJS::Identifier>("b"),
+                            program->make<LibJS::BinaryExpression>(
                                     LibJS::BinaryExpression::BinaryOperator::Multiply,
-                                    std::make_unique<LibJS::Literal>(LibJS::Value(10)),
-                                    std::make_unique<LibJS::Literal>(LibJS::Value(2))
+                                    program->make<LibJS::Literal>(LibJS::Value(10)),
+                                    program->make<LibJS::Literal>(LibJS::Value(2))
                             )
                     )
-            }
+            })
 
     );
     program->append<LibJS::VariableDeclaration>(
             LibJS::VariableDeclaration::Kind::Const,
-            std::vector<LibJS::SharedPtr<LibJS::VariableDeclarator>>{
-                    std::make_shared<LibJS::VariableDeclarator>(
-                            std::make_unique<LibJS::Identifier>("a"),
-                            std::make_unique<LibJS::BinaryExpression>(
+            program->makeArray<LibJS::VariableDeclarator *>({
+                    program->make<LibJS::VariableDeclarator>(
+                            program->make<LibJS::Identifier>("a"),
+                            program->make<LibJS::BinaryExpression>(
                                     LibJS::BinaryExpression::BinaryOperator::Add,
-                                    std::make_unique<LibJS::Identifier>("b"),
-                                    std::make_unique<LibJS::Literal>(LibJS::Value(1))
+                                    program->make<LibJS::Identifier>("b"),
+                                    program->make<LibJS::Literal>(LibJS::Value(1))
                             )
                     )
-            }
+            })
     );
 
-    program->append<LibJS::FunctionDeclaration>(LibJS::FunctionDeclaration(
-            std::make_shared<LibJS::Identifier>("inc"),
-            std::make_shared<LibJS::BlockStatement>(
-                    LibJS::Vector<LibJS::SharedPtr<LibJS::Statement>>{
-                            std::make_shared<LibJS::ReturnStatement>(
-                                    std::make_unique<LibJS::BinaryExpression>(
+    program->append<LibJS::FunctionDeclaration>(
+            program->make<LibJS::Identifier>("inc"),
+            program->make<LibJS::BlockStatement>(
+                    program->makeArray<LibJS::Statement *>({
+                            program->make<LibJS::ReturnStatement>(
+                                    program->make<LibJS::BinaryExpression>(
                                             LibJS::BinaryExpression::BinaryOperator::Add,
-                                            std::make_unique<LibJS::Literal>(LibJS::Value(3)),
-                                            std::make_unique<LibJS::Literal>(LibJS::Value(1))
+                                            program->make<LibJS::Literal>(LibJS::Value(3)),
+                                            program->make<LibJS::Literal>(LibJS::Value(1))
                                     )
                             )
-                    }
-            )));
+                    })
+            ));
 
     program->append<LibJS::ExpressionStatement>(
-            std::make_unique<LibJS::CallExpression>(
-                    std::make_unique<LibJS::Identifier>("inc")
+            program->make<LibJS::CallExpression>(
+                    program->make<LibJS::Identifier>("inc")
             )
     );
 
@@ -72,40 +81,160 @@ int main() {
 
     program->append<LibJS::VariableDeclaration>(
             LibJS::VariableDeclaration::Kind::Let,
-            std::vector<LibJS::SharedPtr<LibJS::VariableDeclarator>>{
-                    std::make_shared<LibJS::VariableDeclarator>(
-                            std::make_unique<LibJS::Identifier>("t"),
-                            std::make_unique<LibJS::Literal>(LibJS::Value(2))
+            program->makeArray<LibJS::VariableDeclarator *>({
+                    program->make<LibJS::VariableDeclarator>(
+                            program->make<LibJS::Identifier>("t"),
+                            program->make<LibJS::Literal>(LibJS::Value(2))
                     )
-            }
+            })
 
     );
 
     program->append<LibJS::IfStatement>(
-            std::make_unique<LibJS::BinaryExpression>(
+            program->make<LibJS::BinaryExpression>(
                     LibJS::BinaryExpression::BinaryExpression::BinaryOperator::GreaterThan,
-                    std::make_unique<LibJS::Literal>(LibJS::Value(10)),
-                    std::make_unique<LibJS::Literal>(LibJS::Value(2))
+                    program->make<LibJS::Literal>(LibJS::Value(10)),
+                    program->make<LibJS::Literal>(LibJS::Value(2))
             ),
-            std::make_unique<LibJS::BlockStatement>(
-                    LibJS::Vector<LibJS::SharedPtr<LibJS::Statement>>{
-                            std::make_shared<LibJS::ExpressionStatement>(
-                                    std::make_unique<LibJS::AssignmentExpression>(
+            program->make<LibJS::BlockStatement>(
+                    program->makeArray<LibJS::Statement *>({
+                            program->make<LibJS::ExpressionStatement>(
+                                    program->make<LibJS::AssignmentExpression>(
                                             LibJS::AssignmentExpression::AssignmentOperator::MultiplicationAssignment,
-                                            std::make_unique<LibJS::Identifier>("t"),
-                                            std::make_unique<LibJS::Literal>(LibJS::Value(2))
+                                            program->make<LibJS::Identifier>("t"),
+                                            program->make<LibJS::Literal>(LibJS::Value(2))
                                     )
                             )
-                    }
+                    })
             )
 
     );
 
+    return program;
+}
+
+// Usage: LibJS [--closure | --bytecode] [--no-jit] [script.js]. Without a script the demo program above is run.
+// --no-jit keeps hot functions in the bytecode VM. --profile <file> samples the script while it runs, writes the collapsed
+// stacks to the file and prints the functions that took the most time. --stats <file> writes the runtime counters as
+// JSON, they are only counted in builds with LIBJS_RUNTIME_STATS. --code-cache <directory> loads the parsed script from
+// the directory instead of parsing it when the source is unchanged, and stores it there otherwise.
+// An uncaught exception is printed to stderr and makes the exit code 1.
+//
+// LibJS [--closure | --bytecode] [--no-jit] --workloads [--baseline <file>] [--threshold <percent>]
+// [--rounds <count>] [--runs <count>] [--update-baseline] runs the scripts in Benchmarks/Workloads instead and compares
+// their median time and peak RSS with the baseline, the exit code is 1 on a regression. On a noisier machine, record
+// a baseline of its own with --baseline <file> --update-baseline, or raise --threshold.
+int main(int argc, char **argv) {
+    auto mode = LibJS::Interpreter::ExecutionMode::AST;
+    bool useJit = true;
+    const char *scriptPath = nullptr;
+    const char *profilePath = nullptr;
+    const char *statsPath = nullptr;
+    const char *codeCachePath = nullptr;
+    bool runWorkloads = false;
+    LibJS::Benchmark::WorkloadOptions workloadOptions;
+    workloadOptions.directory = LIBJS_WORKLOAD_DIRECTORY;
+    workloadOptions.baselinePath = LIBJS_WORKLOAD_DIRECTORY "/baseline.txt";
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--bytecode") == 0) {
+            mode = LibJS::Interpreter::ExecutionMode::Bytecode;
+        } else if (std::strcmp(argv[i], "--closure") == 0) {
+            mode = LibJS::Interpreter::ExecutionMode::Closure;
+        } else if (std::strcmp(argv[i], "--no-jit") == 0) {
+            useJit = false;
+        } else if (std::strcmp(argv[i], "--profile") == 0 && i + 1 < argc) {
+            profilePath = argv[++i];
+        } else if (std::strcmp(argv[i], "--stats") == 0 && i + 1 < argc) {
+            statsPath = argv[++i];
+        } else if (std::strcmp(argv[i], "--code-cache") == 0 && i + 1 < argc) {
+            codeCachePath = argv[++i];
+        } else if (std::strcmp(argv[i], "--workloads") == 0) {
+            runWorkloads = true;
+        } else if (std::strcmp(argv[i], "--baseline") == 0 && i + 1 < argc) {
+            workloadOptions.baselinePath = argv[++i];
+        } else if (std::strcmp(argv[i], "--threshold") == 0 && i + 1 < argc) {
+            workloadOptions.thresholdPercent = std::atof(argv[++i]);
+        } else if (std::strcmp(argv[i], "--rounds") == 0 && i + 1 < argc) {
+            workloadOptions.rounds = std::max(1, std::atoi(argv[++i]));
+        } else if (std::strcmp(argv[i], "--runs") == 0 && i + 1 < argc) {
+            workloadOptions.runs = std::max(1, std::atoi(argv[++i]));
+        } else if (std::strcmp(argv[i], "--update-baseline") == 0) {
+            workloadOptions.updateBaseline = true;
+        } else {
+            scriptPath = argv[i];
+        }
+    }
+
+    if (runWorkloads) {
+        workloadOptions.mode = mode;
+        workloadOptions.jit = useJit;
+        return LibJS::Benchmark::runWorkloads(workloadOptions);
+    }
+
+    // Created before parsing so that its stats include the parse, and destroyed before the program it runs.
+    LibJS::UniquePtr<LibJS::Program> program;
+    LibJS::Interpreter interpreter(mode);
+    interpreter.setJitEnabled(useJit);
+    if (scriptPath) {
+        std::ifstream file(scriptPath, std::ios::binary);
+        if (!file) {
+            std::cerr << "Could not open " << scriptPath << std::endl;
+            return 1;
+        }
+        std::stringstream source;
+        source << file.rdbuf();
+        const LibJS::String sourceText = source.str();
+
+        const LibJS::RuntimeStats::PhaseScope parsing(LibJS::RuntimeStats::Phase::Parsing);
+        const LibJS::CodeCache codeCache(codeCachePath ? codeCachePath : "");
+        if (codeCachePath) {
+            program = codeCache.load(sourceText);
+        }
+        if (!program) {
+            LibJS::Parser parser(sourceText);
+            program = parser.parseProgram();
+            if (parser.hasError()) {
+                std::cerr << scriptPath << ": " << parser.error() << std::endl;
+                return 1;
+            }
+            if (codeCachePath) {
+                codeCache.store(*program, sourceText);
+            }
+        }
+    } else {
+        program = buildDemoProgram();
+    }
+
     program->print();
 
-    LibJS::Interpreter interpreter;
+    LibJS::Profiler profiler(interpreter);
+    if (profilePath) {
+        profiler.start();
+    }
     program->execute(interpreter);
+    const bool uncaught = interpreter.completion() == LibJS::Completion::Throw;
+    if (uncaught) {
+        std::cerr << "Uncaught exception: " << interpreter.clearCompletion().toString() << std::endl;
+    }
+    if (profilePath) {
+        profiler.stop();
+        std::ofstream profile(profilePath);
+        if (!profile) {
+            std::cerr << "Could not write " << profilePath << std::endl;
+            return 1;
+        }
+        profiler.writeCollapsedStacks(profile);
+        profiler.printTopEntries(std::cerr, 20);
+    }
+    if (statsPath) {
+        std::ofstream stats(statsPath);
+        if (!stats) {
+            std::cerr << "Could not write " << statsPath << std::endl;
+            return 1;
+        }
+        interpreter.stats().dumpJson(stats);
+    }
     interpreter.dumpStack();
 
-    return 0;
+    return uncaught ? 1 : 0;
 }